@@ -0,0 +1,121 @@
+#ifndef BENCHCOMMON_H
+#define BENCHCOMMON_H
+
+/**
+ * Helpers shared by the benchmark tools of bench/: a monotonic timer, the statistics of a set of timings and
+ * the JSON output. Every tool writes one JSON document to the file named on its command line (to stdout when no
+ * file is given) and prints its progress on stderr, so the JSON of two versions can be compared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Statistics of a set of timings, in nanoseconds
+typedef struct {
+    int count;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+} TimeStats;
+
+/**
+ * Returns a monotonic time stamp in nanoseconds.
+ */
+static inline double nowNanoseconds(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+#endif
+}
+
+static inline int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts a set of timings and works out their statistics.
+ *
+ * Parameters:
+ *   - double *times: The timings, sorted in place.
+ *   - int count: The number of timings (every statistic is 0 when there are none).
+ *
+ * Returns:
+ *   - TimeStats: The mean, median, p90, p99 and worst timing.
+ */
+static inline TimeStats summarizeTimes(double *times, int count) {
+    TimeStats stats = {count, 0, 0, 0, 0, 0};
+    int i;
+    if (count <= 0) {
+        return stats;
+    }
+
+    qsort(times, count, sizeof(double), compareDoubles);
+    for (i = 0; i < count; i++) {
+        stats.mean += times[i] / count;
+    }
+    stats.p50 = times[count / 2];
+    stats.p90 = times[(int)(count * 0.9)];
+    stats.p99 = times[(int)(count * 0.99)];
+    stats.max = times[count - 1];
+    return stats;
+}
+
+/**
+ * Writes the statistics as the JSON fields "<prefix>mean_ns" .. "<prefix>max_ns", without braces or a trailing
+ * comma, so they sit in the object of the caller.
+ *
+ * Parameters:
+ *   - FILE *out: The JSON output.
+ *   - const char *prefix: Prefix of the field names ("" for none).
+ *   - const TimeStats *stats: The statistics.
+ */
+static inline void writeTimeStats(FILE *out, const char *prefix, const TimeStats *stats) {
+    fprintf(out, "\"%smean_ns\": %.0f, \"%sp50_ns\": %.0f, \"%sp90_ns\": %.0f, \"%sp99_ns\": %.0f, \"%smax_ns\": %.0f",
+            prefix, stats->mean, prefix, stats->p50, prefix, stats->p90, prefix, stats->p99, prefix, stats->max);
+}
+
+/**
+ * Opens the JSON output of a tool.
+ *
+ * Parameters:
+ *   - const char *outputFile: The file named on the command line (NULL for stdout).
+ *
+ * Returns:
+ *   - FILE*: The output, or NULL if the file couldn't be opened (the error is printed).
+ */
+static inline FILE* openBenchOutput(const char *outputFile) {
+    FILE *out = outputFile ? fopen(outputFile, "w") : stdout;
+    if (!out) {
+        perror("Error opening output file");
+    }
+    return out;
+}
+
+/**
+ * Closes the JSON output of a tool (stdout is left open).
+ */
+static inline void closeBenchOutput(FILE *out) {
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+#endif
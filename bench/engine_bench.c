@@ -0,0 +1,264 @@
+/**
+ * Micro-benchmarks for the hot paths of the board engine (placeMines, calculateAdjacentMines,
+ * floodFill, checkWin and the save/load of the cell records).
+ * Every operation runs on the three built-in modes and on large synthetic boards at a range of
+ * mine densities, and the results are written as JSON so versions can be compared.
+ *
+ * Usage: engine_bench [output.json] [--quick]
+ *
+ * Allocations are counted by wrapping malloc/calloc/realloc at link time
+ * (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, see the Bench target of the project).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/engine.h"
+#include "bench_common.h"
+
+/**ALLOCATION COUNTER**/
+static unsigned long allocationCount = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocationCount++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocationCount++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    allocationCount++;
+    return __real_realloc(pointer, size);
+}
+
+/**BENCHMARK CASES**/
+
+// State shared by the operations of one board configuration
+typedef struct {
+    const char *label;        // Name of the configuration (mode name or "synthetic")
+    int rows;
+    int cols;
+    int numMines;
+    MineField field;          // Field the operations run on
+    FILE *file;               // Scratch save file for the save/load operations
+    int startRow;             // First clicked cell (always the middle of the board)
+    int startCol;
+    uint64_t seedCounter;     // Changes the seed between placements
+    volatile int sink;        // Keeps the compiler from dropping results
+} BenchCase;
+
+// One benchmarked operation: setup runs before every op and its cost is measured separately and subtracted
+typedef struct {
+    const char *name;
+    void (*setup)(BenchCase *bench);
+    void (*run)(BenchCase *bench);
+} BenchOp;
+
+/**
+ * Builds a played board: mines placed around the middle cell and adjacent counts calculated.
+ */
+static void prepareField(BenchCase *bench) {
+    clearBoard(&bench->field.grid);
+    bench->field.numMines = bench->numMines;
+    bench->field.firstClick = 0;
+    placeMines(&bench->field, bench->startRow, bench->startCol);
+    calculateAdjacentMines(&bench->field);
+    bench->field.firstClick = 1;
+}
+
+static void setupNothing(BenchCase *bench) {
+    (void)bench;
+}
+
+static void setupPlaceMines(BenchCase *bench) {
+    memset(bench->field.grid.mines, 0, bench->field.grid.planeWords * sizeof(uint32_t));
+    bench->field.numMines = bench->numMines;
+    bench->field.seed = ++bench->seedCounter;
+}
+
+static void runPlaceMines(BenchCase *bench) {
+    placeMines(&bench->field, bench->startRow, bench->startCol);
+}
+
+static void runCalculateAdjacentMines(BenchCase *bench) {
+    calculateAdjacentMines(&bench->field);
+}
+
+static void setupFloodFill(BenchCase *bench) {
+    memset(bench->field.grid.revealed, 0, bench->field.grid.planeWords * sizeof(uint32_t));
+}
+
+static void runFloodFill(BenchCase *bench) {
+    bench->sink += floodFill(&bench->field, bench->startRow, bench->startCol);
+}
+
+static void runCheckWin(BenchCase *bench) {
+    bench->sink += checkWin(&bench->field);
+}
+
+static void setupRewind(BenchCase *bench) {
+    rewind(bench->file);
+}
+
+static void runSave(BenchCase *bench) {
+    saveMineFieldCells(&bench->field, bench->file);
+    fflush(bench->file);
+}
+
+static void runLoad(BenchCase *bench) {
+    bench->sink += loadMineFieldCells(&bench->field, bench->file);
+}
+
+static const BenchOp benchOps[] = {
+    {"placeMines", setupPlaceMines, runPlaceMines},
+    {"calculateAdjacentMines", setupNothing, runCalculateAdjacentMines},
+    {"floodFill", setupFloodFill, runFloodFill},
+    {"checkWin", setupNothing, runCheckWin},
+    {"saveGameGrid", setupRewind, runSave},
+    {"loadGameGrid", setupRewind, runLoad},
+};
+#define NUM_BENCH_OPS (int)(sizeof(benchOps) / sizeof(benchOps[0]))
+
+/**
+ * Times `iterations` rounds of setup + run, and of setup alone, and returns the difference per op.
+ * The allocation count of the setup rounds is subtracted the same way.
+ */
+static double timeOperation(BenchCase *bench, const BenchOp *op, long iterations, double *allocsPerOp) {
+    long i;
+    unsigned long allocations = allocationCount;
+    double start = nowNanoseconds();
+    for (i = 0; i < iterations; i++) {
+        op->setup(bench);
+        op->run(bench);
+    }
+    double withRun = nowNanoseconds() - start;
+    unsigned long runAllocations = allocationCount - allocations;
+
+    allocations = allocationCount;
+    start = nowNanoseconds();
+    for (i = 0; i < iterations; i++) {
+        op->setup(bench);
+    }
+    double setupOnly = nowNanoseconds() - start;
+    unsigned long setupAllocations = allocationCount - allocations;
+
+    *allocsPerOp = (double)(runAllocations - setupAllocations) / iterations;
+    double perOp = (withRun - setupOnly) / iterations;
+    return perOp > 0 ? perOp : 0;
+}
+
+/**
+ * Runs one operation on one board: the iteration count is doubled until a round lasts the time budget,
+ * then the result is written as one JSON object.
+ */
+static void benchmarkOperation(BenchCase *bench, const BenchOp *op, double budgetNanoseconds, FILE *out, int *first) {
+    long iterations = 1;
+    double allocsPerOp = 0, nsPerOp = 0;
+
+    // The flood fill, save and load need the state the previous operations leave behind
+    prepareField(bench);
+    if (op->run == runLoad) {
+        rewind(bench->file);
+        runSave(bench);
+    }
+
+    for (;;) {
+        double start = nowNanoseconds();
+        nsPerOp = timeOperation(bench, op, iterations, &allocsPerOp);
+        if (nowNanoseconds() - start >= budgetNanoseconds || iterations >= (1L << 24)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double cells = (double)bench->rows * bench->cols;
+    fprintf(out, "%s\n    {\"op\": \"%s\", \"board\": \"%s\", \"rows\": %d, \"cols\": %d, \"mines\": %d, "
+                 "\"density\": %.4f, \"iterations\": %ld, \"ns_per_op\": %.1f, \"cells_per_s\": %.0f, \"allocs_per_op\": %.2f}",
+            *first ? "" : ",", op->name, bench->label, bench->rows, bench->cols, bench->numMines,
+            bench->numMines / cells, iterations, nsPerOp, nsPerOp > 0 ? cells * 1e9 / nsPerOp : 0, allocsPerOp);
+    *first = 0;
+
+    fprintf(stderr, "%-24s %-10s %5dx%-5d %7d mines %14.1f ns/op\n", op->name, bench->label, bench->rows, bench->cols, bench->numMines, nsPerOp);
+}
+
+/**
+ * Runs every operation on one board configuration.
+ */
+static void benchmarkBoard(const char *label, int rows, int cols, int numMines, double budgetNanoseconds, FILE *out, int *first) {
+    BenchCase bench;
+    int i;
+
+    bench.label = label;
+    bench.rows = rows;
+    bench.cols = cols;
+    bench.numMines = numMines;
+    bench.startRow = rows / 2;
+    bench.startCol = cols / 2;
+    bench.seedCounter = 1;
+    bench.sink = 0;
+    bench.file = tmpfile();
+    if (!bench.file || !initMineField(&bench.field, rows, cols, numMines, bench.seedCounter)) {
+        fprintf(stderr, "Failed to set up the %dx%d board\n", rows, cols);
+        if (bench.file) {
+            fclose(bench.file);
+        }
+        return;
+    }
+
+    for (i = 0; i < NUM_BENCH_OPS; i++) {
+        benchmarkOperation(&bench, &benchOps[i], budgetNanoseconds, out, first);
+    }
+
+    freeMineField(&bench.field);
+    fclose(bench.file);
+}
+
+int main(int argc, char *argv[]) {
+    const char *outputFile = NULL;
+    int quick = 0;
+    int i, j;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else {
+            outputFile = argv[i];
+        }
+    }
+
+    FILE *out = openBenchOutput(outputFile);
+    if (!out) {
+        return 1;
+    }
+
+    double budget = quick ? 2e6 : 100e6;  // Time spent on each measurement round (ns)
+    int first = 1;
+
+    fprintf(out, "{\n  \"benchmarks\": [");
+
+    // Built-in modes (same presets as openGame)
+    for (i = 0; i < NUM_MODE_PRESETS; i++) {
+        benchmarkBoard(modePresets[i].name, modePresets[i].rows, modePresets[i].cols, modePresets[i].numMines, budget, out, &first);
+    }
+
+    // Large synthetic boards at a range of mine densities
+    const int sizes[][2] = {{256, 256}, {1000, 1000}};
+    const double densities[] = {0.05, 0.12, 0.2063, 0.35, 0.6, 0.9};
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        for (j = 0; j < (int)(sizeof(densities) / sizeof(densities[0])); j++) {
+            int cells = sizes[i][0] * sizes[i][1];
+            benchmarkBoard("synthetic", sizes[i][0], sizes[i][1], (int)(cells * densities[j]), budget, out, &first);
+        }
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    closeBenchOutput(out);
+    return 0;
+}
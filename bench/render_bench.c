@@ -0,0 +1,258 @@
+/**
+ * Benchmark of the grid drawing: the per-cell path (one blitSurface of a cell image per cell, as drawCell did
+ * before the tile atlas) against compositeGrid (one pass copying row spans out of the tile atlas), on one thread
+ * and split into horizontal bands drawn by the frame band threads (see frame_bands.h).
+ * Both draw the same boards into a 32-bit software surface the size of the grid: the Hard mode (16x30, 30 pixel
+ * cells) and a 200x200 board (8 pixel cells), played a little so they show numbers, empty cells and flags.
+ * The cell images are generated (a colour per tile with a border), so the tool needs no image files and no
+ * window. For every board it reports the frame time statistics of the three paths and whether they
+ * drew the same pixels, as JSON.
+ *
+ * Usage: render_bench [--frames N] [--threads N] [--quick] [output.json]
+ * (--threads sets the number of bands, every core by default)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "../include/engine.h"
+#include "../include/tile_atlas.h"
+#include "../include/surface_format.h"
+#include "../include/frame_bands.h"
+#include "bench_common.h"
+
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int numMines;
+    int cellSize;
+} RenderCase;
+
+static const RenderCase renderCases[] = {
+    {"Hard", 16, 30, 99, 30},
+    {"200x200", 200, 200, 6000, 8}
+};
+
+#define NUM_RENDER_CASES (int)(sizeof(renderCases) / sizeof(renderCases[0]))
+
+/**SETUP**/
+
+/**
+ * Makes a 32-bit surface of the format every surface of the benchmark uses (the window format of the game).
+ */
+static SDL_Surface* createFrameSurface(int width, int height) {
+    return SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+}
+
+/**
+ * Generates the 12 cell images: a different colour per tile with a darker one pixel border, so a tile drawn
+ * at the wrong place or with the wrong offset changes the pixels.
+ */
+static int createTiles(SDL_Surface *tiles[TILE_COUNT], int size) {
+    int i;
+    for (i = 0; i < TILE_COUNT; i++) {
+        tiles[i] = createFrameSurface(size, size);
+        if (!tiles[i]) {
+            return 0;
+        }
+        Uint32 colour = SDL_MapRGB(tiles[i]->format, (Uint8)(i * 20), (Uint8)(255 - i * 20), (Uint8)(i * 37));
+        SDL_Rect inner = {1, 1, size - 2, size - 2};
+        SDL_FillRect(tiles[i], NULL, SDL_MapRGB(tiles[i]->format, 0, 0, (Uint8)i));
+        SDL_FillRect(tiles[i], &inner, colour);
+    }
+    return 1;
+}
+
+/**
+ * Sets up a board of a case the way a game in progress looks: opened from the middle, then a few more cells
+ * revealed and some flags placed, at fixed positions.
+ */
+static int createBoard(MineField *field, const RenderCase *renderCase) {
+    int i;
+    if (!initMineField(field, renderCase->rows, renderCase->cols, renderCase->numMines, 1)) {
+        return 0;
+    }
+    revealCell(field, renderCase->rows / 2, renderCase->cols / 2);
+    for (i = 0; i < renderCase->rows * renderCase->cols && field->gameState == 0; i += 7) {
+        int row = i / renderCase->cols, col = i % renderCase->cols;
+        if (isMineCell(&field->grid, row, col)) {
+            toggleFlag(field, row, col);
+        } else if (i % 3 == 0) {
+            revealCell(field, row, col);
+        }
+    }
+    return 1;
+}
+
+/**DRAWING**/
+
+/**
+ * Draws the grid with one blit per cell, from the separate cell images (the drawing before the tile atlas).
+ */
+static void drawGridPerCell(SDL_Surface *screen, SDL_Surface *tiles[TILE_COUNT], const Board *board, int size) {
+    int row, col;
+    for (row = 0; row < board->rows; row++) {
+        for (col = 0; col < board->cols; col++) {
+            SDL_Rect destRect = {col * size, row * size, size, size};
+            blitSurface(tiles[cellTile(board, row, col)], NULL, screen, &destRect);
+        }
+    }
+}
+
+/**TIMING**/
+
+// Ways of drawing the grid that are timed
+#define DRAW_PER_CELL 0
+#define DRAW_ATLAS 1
+#define DRAW_BANDS 2
+
+/**
+ * Draws the grid once with one of the paths. The banded frame is recorded, queued and drawn by the bands like a
+ * full redraw of the game.
+ */
+static void drawFrame(SDL_Surface *screen, SDL_Surface *tiles[TILE_COUNT], TileAtlas *atlas, const Board *board,
+                      int path) {
+    if (path == DRAW_PER_CELL) {
+        drawGridPerCell(screen, tiles, board, atlas->size);
+    } else if (path == DRAW_ATLAS) {
+        compositeGrid(screen, atlas, board, 0, 0);
+    } else {
+        SDL_Rect whole = {0, 0, screen->w, screen->h};
+        beginFrameBands(screen);
+        if (!queueBandGrid(screen, atlas, board, 0, 0, whole)) {
+            compositeGrid(screen, atlas, board, 0, 0);
+        }
+        endFrameBands();
+    }
+}
+
+/**
+ * Draws the grid `frames` times with one of the paths and returns the statistics of the frame times.
+ */
+static TimeStats timeFrames(SDL_Surface *screen, SDL_Surface *tiles[TILE_COUNT], TileAtlas *atlas, const Board *board,
+                            int path, int frames, double *times) {
+    int i;
+    for (i = 0; i < frames; i++) {
+        double start = nowNanoseconds();
+        drawFrame(screen, tiles, atlas, board, path);
+        times[i] = nowNanoseconds() - start;
+    }
+    return summarizeTimes(times, frames);
+}
+
+/**
+ * Checks that two paths drew the same pixels.
+ */
+static int sameFrames(SDL_Surface *a, SDL_Surface *b) {
+    int y;
+    for (y = 0; y < a->h; y++) {
+        if (memcmp((Uint8*)a->pixels + y * a->pitch, (Uint8*)b->pixels + y * b->pitch, a->w * 4) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Times the paths on a case and writes their statistics as one JSON object.
+ */
+static void benchmarkCase(const RenderCase *renderCase, int frames, FILE *out, int *first) {
+    SDL_Surface *tiles[TILE_COUNT] = {NULL};
+    TileAtlas atlas = {NULL, 0, NULL, 0};
+    MineField field;
+    int size = renderCase->cellSize, i;
+
+    SDL_Surface *blitFrame = createFrameSurface(renderCase->cols * size, renderCase->rows * size);
+    SDL_Surface *atlasFrame = createFrameSurface(renderCase->cols * size, renderCase->rows * size);
+    SDL_Surface *bandsFrame = createFrameSurface(renderCase->cols * size, renderCase->rows * size);
+    double *blitTimes = malloc(frames * sizeof(double));
+    double *atlasTimes = malloc(frames * sizeof(double));
+    double *bandsTimes = malloc(frames * sizeof(double));
+    memset(&field, 0, sizeof(MineField));
+    if (!blitFrame || !atlasFrame || !bandsFrame || !blitTimes || !atlasTimes || !bandsTimes ||
+        !createTiles(tiles, size) ||
+        !buildTileAtlas(&atlas, tiles, size, blitFrame) || !createBoard(&field, renderCase)) {
+        fprintf(stderr, "Failed to set up the %s benchmark\n", renderCase->name);
+    } else {
+        // Warm up the caches and the row buffers of the atlas and of the bands
+        drawFrame(blitFrame, tiles, &atlas, &field.grid, DRAW_PER_CELL);
+        drawFrame(atlasFrame, tiles, &atlas, &field.grid, DRAW_ATLAS);
+        drawFrame(bandsFrame, tiles, &atlas, &field.grid, DRAW_BANDS);
+        int identical = sameFrames(blitFrame, atlasFrame) && sameFrames(blitFrame, bandsFrame);
+
+        TimeStats blit = timeFrames(blitFrame, tiles, &atlas, &field.grid, DRAW_PER_CELL, frames, blitTimes);
+        TimeStats atlasStats = timeFrames(atlasFrame, tiles, &atlas, &field.grid, DRAW_ATLAS, frames, atlasTimes);
+        TimeStats bands = timeFrames(bandsFrame, tiles, &atlas, &field.grid, DRAW_BANDS, frames, bandsTimes);
+
+        fprintf(out, "%s\n    {\"board\": \"%s\", \"rows\": %d, \"cols\": %d, \"cell_size\": %d, \"frames\": %d, ",
+                *first ? "" : ",", renderCase->name, renderCase->rows, renderCase->cols, size, frames);
+        writeTimeStats(out, "blit_", &blit);
+        fprintf(out, ", ");
+        writeTimeStats(out, "atlas_", &atlasStats);
+        fprintf(out, ", ");
+        writeTimeStats(out, "bands_", &bands);
+        fprintf(out, ", \"speedup\": %.2f, \"bands_speedup\": %.2f, \"identical\": %s}",
+                atlasStats.mean > 0 ? blit.mean / atlasStats.mean : 0, bands.mean > 0 ? atlasStats.mean / bands.mean : 0,
+                identical ? "true" : "false");
+        *first = 0;
+
+        fprintf(stderr, "%-8s blit mean %10.0f ns  atlas mean %10.0f ns  bands mean %10.0f ns  speedup %5.2f  "
+                        "bands speedup %5.2f  %s\n", renderCase->name, blit.mean, atlasStats.mean, bands.mean,
+                atlasStats.mean > 0 ? blit.mean / atlasStats.mean : 0, bands.mean > 0 ? atlasStats.mean / bands.mean : 0,
+                identical ? "identical" : "DIFFERENT");
+    }
+
+    for (i = 0; i < TILE_COUNT; i++) {
+        if (tiles[i]) SDL_FreeSurface(tiles[i]);
+    }
+    if (blitFrame) SDL_FreeSurface(blitFrame);
+    if (atlasFrame) SDL_FreeSurface(atlasFrame);
+    if (bandsFrame) SDL_FreeSurface(bandsFrame);
+    freeTileAtlas(&atlas);
+    freeMineField(&field);
+    free(blitTimes);
+    free(atlasTimes);
+    free(bandsTimes);
+}
+
+int main(int argc, char *argv[]) {
+    const char *outputFile = NULL;
+    int frames = 500;
+    int threads = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            frames = 20;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            outputFile = argv[i];
+        }
+    }
+    if (frames < 1) {
+        frames = 1;
+    }
+
+    FILE *out = openBenchOutput(outputFile);
+    if (!out) {
+        return 1;
+    }
+
+    initFrameBands(threads);
+
+    int first = 1;
+    fprintf(out, "{\n  \"frames\": %d,\n  \"bands\": %d,\n  \"grid\": [", frames, getFrameBandCount());
+    for (i = 0; i < NUM_RENDER_CASES; i++) {
+        benchmarkCase(&renderCases[i], frames, out, &first);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    freeFrameBands();
+
+    closeBenchOutput(out);
+    return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * Headless rendering harness: draws every screen of the game (menu, modes, a game of each difficulty, game over,
+ * achievements, settings) into an offscreen window (SDL's dummy video driver, see initializeHeadlessSdl), with
+ * the same calls the main loop makes for a full redraw, for a number of frames each. For every screen it reports
+ * the mean, median, p90, p99 and worst frame time as JSON, and compares the first frame with a golden image
+ * (<golden dir>/<screen>.bmp), so rendering slowdowns and visual breakage show up on a machine without a display.
+ *
+ * The frames are reproducible: the background moves with frameTimer, which restarts at 0 for every screen, the
+ * boards are placed from a fixed seed and opened at fixed cells, the game timer is held at 00:00, the player is
+ * a new one (no achievements, no best times) and no file of the player is read or written.
+ * Run it from the project directory, the assets are loaded from there like in the game.
+ *
+ * Usage: screen_harness [--frames N] [--quick] [--threads N] [--golden DIR] [--update-golden]
+ *                       [--tolerance PIXELS] [--budget-ms MS] [output.json]
+ * --update-golden writes the golden images instead of comparing them (into bench/golden by default, the directory
+ * is created if needed), --tolerance is the number of pixels that may differ from a golden image, --budget-ms
+ * fails the screens whose p99 frame time is above it.
+ * The exit code is 1 when a screen has no golden image, differs from it or is over budget.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_image.h>
+#include "../include/struct.h"
+#include "../include/sdl_init.h"
+#include "../include/screen_manager.h"
+#include "../include/screen_states.h"
+#include "../include/background_renderer.h"
+#include "../include/game_manager.h"
+#include "../include/dirty_rects.h"
+#include "../include/frame_bands.h"
+#include "../include/text_cache.h"
+#include "../include/surface_format.h"
+#include "../include/asset_cache.h"
+#include "bench_common.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Seed the mines of the harness games are placed from
+#define HARNESS_SEED 20240601ULL
+
+// Longest golden image path
+#define GOLDEN_PATH_LENGTH 512
+
+// Board set up before a screen is drawn
+typedef enum {
+    BOARD_NONE,      // The screen doesn't show the game
+    BOARD_PLAYING,   // A game in progress: opened from the middle, a few mines flagged
+    BOARD_LOST       // The same game, then a mine revealed
+} HarnessBoard;
+
+typedef struct {
+    const char *name;      // Name in the report and of the golden image
+    int screen;            // Screen index (see screen_states.h)
+    GameMode mode;         // Mode of the game, for the screens that show one
+    HarnessBoard board;
+} HarnessCase;
+
+static const HarnessCase harnessCases[] = {
+    {"menu", 0, MODE_EASY, BOARD_NONE},
+    {"mode", 2, MODE_EASY, BOARD_NONE},
+    {"game_easy", 4, MODE_EASY, BOARD_PLAYING},
+    {"game_medium", 4, MODE_MEDIUM, BOARD_PLAYING},
+    {"game_hard", 4, MODE_HARD, BOARD_PLAYING},
+    {"game_over", 5, MODE_EASY, BOARD_LOST},
+    {"achievements", 3, MODE_EASY, BOARD_NONE},
+    {"settings", 6, MODE_EASY, BOARD_NONE}
+};
+
+#define NUM_HARNESS_CASES (int)(sizeof(harnessCases) / sizeof(harnessCases[0]))
+
+// Options of a run
+typedef struct {
+    int frames;
+    const char *goldenDir;
+    int updateGolden;
+    long tolerance;
+    double budgetMs;       // 0 for no budget
+} HarnessOptions;
+
+/**SETUP**/
+
+/**
+ * Starts a game of a mode the way the play button of the mode screen does, then replaces its random seed by
+ * HARNESS_SEED and plays it to a fixed position: the middle cell opened and the first three mines flagged,
+ * and for BOARD_LOST the first mine left revealed.
+ */
+static void setUpBoard(Game *game, const HarnessCase *harnessCase) {
+    int row, col, flags = 0;
+
+    gameMode = harnessCase->mode;
+    openGame();  // Board size and cell size of the mode
+    initializeGame(game);
+    restartMineField(&game->field, gameMinesNum, HARNESS_SEED);
+    revealCell(&game->field, game->field.rows / 2, game->field.cols / 2);
+
+    for (row = 0; row < game->field.rows && flags < 3; row++) {
+        for (col = 0; col < game->field.cols && flags < 3; col++) {
+            if (isMineCell(&game->field.grid, row, col)) {
+                if (harnessCase->board == BOARD_LOST && flags == 0) {
+                    revealCell(&game->field, row, col);
+                } else {
+                    toggleFlag(&game->field, row, col);
+                }
+                flags++;
+            }
+        }
+    }
+}
+
+/**GOLDEN IMAGES**/
+
+/**
+ * Creates the directory the golden images are written to, so --update-golden works on a fresh checkout.
+ *
+ * Returns:
+ *   - int: 1 if the directory exists or was created, 0 otherwise (the error is printed).
+ */
+static int createGoldenDir(const char *goldenDir) {
+#ifdef _WIN32
+    int result = _mkdir(goldenDir);
+#else
+    int result = mkdir(goldenDir, 0755);
+#endif
+    if (result != 0 && errno != EEXIST) {
+        perror("Error creating the golden image directory");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Counts the pixels of the window that differ from a golden image, or writes the image with --update-golden.
+ *
+ * Returns:
+ *   - const char*: "match", "different", "missing", "size" (the image has another size), "updated" or "error".
+ */
+static const char* checkGolden(SDL_Surface *window, const char *name, const HarnessOptions *options, long *diffPixels) {
+    char path[GOLDEN_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s/%s.bmp", options->goldenDir, name);
+    *diffPixels = 0;
+
+    if (options->updateGolden) {
+        if (SDL_SaveBMP(window, path) != 0) {
+            fprintf(stderr, "Failed to write %s: %s\n", path, SDL_GetError());
+            return "error";
+        }
+        return "updated";
+    }
+
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    if (!loaded) {
+        return "missing";
+    }
+    SDL_Surface *golden = SDL_ConvertSurface(loaded, window->format, SDL_SWSURFACE);
+    SDL_FreeSurface(loaded);
+    if (!golden) {
+        fprintf(stderr, "Failed to convert %s: %s\n", path, SDL_GetError());
+        return "error";
+    }
+    if (golden->w != window->w || golden->h != window->h) {
+        SDL_FreeSurface(golden);
+        return "size";
+    }
+
+    // Both surfaces are 32-bit in the window format, compare the pixels without the unused byte
+    Uint32 mask = window->format->Rmask | window->format->Gmask | window->format->Bmask;
+    int x, y;
+    if (SDL_MUSTLOCK(window)) SDL_LockSurface(window);
+    for (y = 0; y < window->h; y++) {
+        const Uint32 *a = (const Uint32 *)((const Uint8 *)window->pixels + y * window->pitch);
+        const Uint32 *b = (const Uint32 *)((const Uint8 *)golden->pixels + y * golden->pitch);
+        for (x = 0; x < window->w; x++) {
+            if ((a[x] ^ b[x]) & mask) {
+                (*diffPixels)++;
+            }
+        }
+    }
+    if (SDL_MUSTLOCK(window)) SDL_UnlockSurface(window);
+    SDL_FreeSurface(golden);
+
+    return *diffPixels <= options->tolerance ? "match" : "different";
+}
+
+/**FRAMES**/
+
+/**
+ * Draws one frame of the active screen in full, like the main loop: background (unless a panel hides it), the
+ * screen, then the window is pushed.
+ */
+static void drawFrame(ScreenContext *context, int activeScreen, SDL_Surface *stars, SDL_Surface *numbers) {
+    frameTimer++;
+    context->game->startTime = SDL_GetTicks();  // Hold the game timer at 00:00
+
+    markFullRedraw(&dirtyRects);
+    beginFrameBands(context->window);
+    if (!hidesBackground(context, activeScreen)) {
+        renderBackground(context->window, stars, numbers);
+    }
+    screenStates[activeScreen].render(context);
+    presentDirtyRects(&dirtyRects, context->window);
+}
+
+/**
+ * Switches to the screen of a case, draws it `frames` times, checks the first frame against its golden image and
+ * writes the statistics as one JSON object.
+ *
+ * Returns:
+ *   - int: 1 if the screen passed, 0 otherwise.
+ */
+static int runCase(ScreenContext *context, int *activeScreen, const HarnessCase *harnessCase,
+                   SDL_Surface *stars, SDL_Surface *numbers, const HarnessOptions *options, FILE *out, int *first) {
+    double *times = malloc(options->frames * sizeof(double));
+    int i;
+    if (!times) {
+        printf("Memory allocation failed for the frame times\n");
+        return 0;
+    }
+
+    if (harnessCase->board != BOARD_NONE) {
+        setUpBoard(context->game, harnessCase);
+    }
+    currentScreen = harnessCase->screen;
+    *activeScreen = applyScreenChange(context, *activeScreen);
+
+    frameTimer = 0;
+    long diffPixels = 0;
+    const char *golden = "error";
+    for (i = 0; i < options->frames; i++) {
+        double start = nowNanoseconds();
+        drawFrame(context, *activeScreen, stars, numbers);
+        times[i] = nowNanoseconds() - start;
+
+        if (i == 0) {
+            golden = checkGolden(context->window, harnessCase->name, options, &diffPixels);
+        }
+    }
+    TimeStats stats = summarizeTimes(times, options->frames);
+
+    int overBudget = options->budgetMs > 0 && stats.p99 > options->budgetMs * 1e6;
+    int passed = !overBudget && (strcmp(golden, "match") == 0 || strcmp(golden, "updated") == 0);
+
+    fprintf(out, "%s\n    {\"screen\": \"%s\", \"frames\": %d, ", *first ? "" : ",", harnessCase->name,
+            options->frames);
+    writeTimeStats(out, "", &stats);
+    fprintf(out, ", \"golden\": \"%s\", \"diff_pixels\": %ld, \"over_budget\": %s}", golden, diffPixels,
+            overBudget ? "true" : "false");
+    *first = 0;
+
+    fprintf(stderr, "%-13s mean %10.0f ns  p50 %10.0f ns  p99 %10.0f ns  golden %-9s (%ld pixels)%s\n",
+            harnessCase->name, stats.mean, stats.p50, stats.p99, golden, diffPixels,
+            overBudget ? "  OVER BUDGET" : "");
+
+    free(times);
+    return passed;
+}
+
+int main(int argc, char *argv[]) {
+    HarnessOptions options = {120, "bench/golden", 0, 0, 0};
+    const char *outputFile = NULL;
+    int threads = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            options.frames = 10;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            options.goldenDir = argv[++i];
+        } else if (strcmp(argv[i], "--update-golden") == 0) {
+            options.updateGolden = 1;
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            options.tolerance = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc) {
+            options.budgetMs = atof(argv[++i]);
+        } else {
+            outputFile = argv[i];
+        }
+    }
+    if (options.frames < 1) {
+        options.frames = 1;
+    }
+    if (options.updateGolden && !createGoldenDir(options.goldenDir)) {
+        return 1;
+    }
+
+    SDL_Surface *window = NULL;
+    if (!initializeHeadlessSdl(&window)) {
+        return 1;
+    }
+    SDL_Surface *stars = convertToDisplayFormat(IMG_Load("assets/background/star_field.png"));
+    SDL_Surface *numbers = convertToDisplayFormat(IMG_Load("assets/background/numbers.png"));
+    prepareBackground(numbers);
+    initializeFonts("assets/fonts/M 8pt.ttf");
+    if (!gameState || !fonts[0]) {
+        SDL_Quit();
+        return 1;  // The fonts couldn't be loaded
+    }
+    initFrameBands(threads);
+
+    // A new player, so the screens don't depend on the files of the player
+    Achievement achievements[TOTAL_ACHIEVEMENTS];
+    PlayerStats playerStats;
+    initializeAchievements(achievements, &playerStats);
+
+    ScreenContext context = {0};
+    Game game = {0};
+    context.window = window;
+    context.menuScreen = createMenuScreen();
+    context.modeScreen = createModeScreen();
+    context.gameScreen = createGameScreen();
+    context.gameOverScreen = createGameOverScreen();
+    context.settingsScreen = createSettingsScreen();
+    context.achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
+    context.achievements = achievements;
+    context.playerStats = &playerStats;
+    context.game = &game;
+    context.skipBestTimes = 1;  // The game over screen would read them from the time.dat of the player
+    setAchievementUnlockedHandler(markAchievementUnlocked, &context.achievementScreen);
+
+    // The game screen needs a game before it is entered, start one in the default mode
+    const HarnessCase defaultGame = {"", 4, MODE_EASY, BOARD_PLAYING};
+    setUpBoard(&game, &defaultGame);
+    int activeScreen = 0;
+    currentScreen = 0;
+    switchScreen(&context, -1, activeScreen);
+
+    FILE *out = openBenchOutput(outputFile);
+    if (!out) {
+        return 1;
+    }
+
+    int first = 1, failed = 0;
+    fprintf(out, "{\n  \"frames\": %d,\n  \"width\": %d,\n  \"height\": %d,\n  \"bands\": %d,\n  \"screens\": [",
+            options.frames, window->w, window->h, getFrameBandCount());
+    for (i = 0; i < NUM_HARNESS_CASES; i++) {
+        int passed = runCase(&context, &activeScreen, &harnessCases[i], stars, numbers, &options, out, &first);
+        if (!gameState) {
+            // Something the screen called gave up on the game, count it as a failure and go on
+            fprintf(stderr, "%s turned the game off\n", harnessCases[i].name);
+            passed = 0;
+            gameState = GAME_ON;
+        }
+        if (!passed) {
+            failed++;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    closeBenchOutput(out);
+    fprintf(stderr, "%d of %d screens passed\n", NUM_HARNESS_CASES - failed, NUM_HARNESS_CASES);
+
+    freeBackground(stars, numbers);
+    freeScreen(context.menuScreen);
+    freeScreen(context.modeScreen);
+    freeScreen(context.gameScreen);
+    freeScreen(context.gameOverScreen);
+    freeScreen(context.achievementScreen);
+    freeScreen(context.settingsScreen);
+    freeGameGrid(&game);
+    freeFrameBands();
+    freeAssetCache();
+    freeTextCache();
+    cleanupFonts();
+    IMG_Quit();
+    SDL_Quit();
+
+    return failed ? 1 : 0;
+}
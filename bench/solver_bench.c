@@ -0,0 +1,257 @@
+/**
+ * Benchmark of the solver (solveMineField) on recorded positions.
+ * Positions are recorded by playing seeded games on the three built-in modes, clicking the safest cell the solver
+ * finds after every move and keeping the field as it was before each click. They can be written to a file with
+ * --record and replayed later with --positions, so two versions of the solver are timed on the same positions.
+ * For every mode the tool reports the mean, median, p90, p99 and worst solve time, how many positions went over
+ * a 60 FPS frame (16.7 ms) and how many could not be solved exactly, as JSON.
+ *
+ * Usage: solver_bench [--games N] [--record positions.dat | --positions positions.dat] [--quick] [output.json]
+ *
+ * Position file: for every position rows, cols, numMines (ints) followed by one Cell record per cell (saveMineFieldCells).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/engine.h"
+#include "../include/solver.h"
+#include "bench_common.h"
+
+#define FRAME_BUDGET_NS 16.7e6
+
+/**POSITIONS**/
+
+// Growable list of recorded positions
+typedef struct {
+    MineField *fields;
+    int count;
+    int capacity;
+} PositionList;
+
+/**
+ * Appends a copy of the field's visible state (and mines, so the position can be replayed) to the list.
+ */
+static int addPosition(PositionList *list, const MineField *field) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        MineField *fields = realloc(list->fields, capacity * sizeof(MineField));
+        if (!fields) {
+            return 0;
+        }
+        list->fields = fields;
+        list->capacity = capacity;
+    }
+
+    MineField *copy = &list->fields[list->count];
+    *copy = *field;
+    if (!initBoard(&copy->grid, field->rows, field->cols)) {
+        return 0;
+    }
+    memcpy(copy->grid.mines, field->grid.mines, 3 * (size_t)field->grid.planeWords * sizeof(uint32_t) + ((size_t)field->rows * field->cols + 1) / 2);
+    list->count++;
+    return 1;
+}
+
+static void freePositions(PositionList *list) {
+    int i;
+    for (i = 0; i < list->count; i++) {
+        freeMineField(&list->fields[i]);
+    }
+    free(list->fields);
+    list->fields = NULL;
+    list->count = list->capacity = 0;
+}
+
+/**
+ * Plays `games` seeded games of a mode with the solver and records the field before every click.
+ */
+static int recordPositions(const ModePreset *mode, int games, PositionList *list) {
+    MineField field;
+    Solver solver;
+    int game, row, col;
+
+    if (!initMineField(&field, mode->rows, mode->cols, mode->numMines, 1) || !initSolver(&solver, mode->rows, mode->cols)) {
+        return 0;
+    }
+
+    for (game = 0; game < games; game++) {
+        restartMineField(&field, mode->numMines, (uint64_t)game + 1);
+        revealCell(&field, mode->rows / 2, mode->cols / 2);
+
+        while (field.gameState == 0) {
+            if (!addPosition(list, &field) || !solveMineField(&solver, &field) || !findSafestCell(&solver, &field, &row, &col)) {
+                freeSolver(&solver);
+                freeMineField(&field);
+                return 0;
+            }
+            revealCell(&field, row, col);
+        }
+    }
+
+    freeSolver(&solver);
+    freeMineField(&field);
+    return 1;
+}
+
+/**
+ * Writes the positions to a file (see the file layout at the top).
+ */
+static int writePositions(const PositionList *list, const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    int i;
+    if (!file) {
+        perror("Error opening position file");
+        return 0;
+    }
+    for (i = 0; i < list->count; i++) {
+        MineField *field = &list->fields[i];
+        fwrite(&field->rows, sizeof(int), 1, file);
+        fwrite(&field->cols, sizeof(int), 1, file);
+        fwrite(&field->numMines, sizeof(int), 1, file);
+        saveMineFieldCells(field, file);
+    }
+    fclose(file);
+    return 1;
+}
+
+/**
+ * Reads the positions of a file written by --record.
+ */
+static int readPositions(PositionList *list, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    MineField field;
+    if (!file) {
+        perror("Error opening position file");
+        return 0;
+    }
+
+    memset(&field, 0, sizeof(MineField));
+    field.firstClick = 1;  // Recorded positions always come after the first click
+    while (fread(&field.rows, sizeof(int), 1, file) == 1) {
+        if (fread(&field.cols, sizeof(int), 1, file) != 1 || fread(&field.numMines, sizeof(int), 1, file) != 1 ||
+            !loadMineFieldCells(&field, file) || !addPosition(list, &field)) {
+            fclose(file);
+            freeMineField(&field);
+            return 0;
+        }
+    }
+    fclose(file);
+    freeMineField(&field);
+    return 1;
+}
+
+/**TIMING**/
+
+/**
+ * Times the positions that have the size of a mode and writes their statistics as one JSON object.
+ * Every position is solved `repeats` times and its time is the average of the runs.
+ */
+static void benchmarkMode(const ModePreset *mode, const PositionList *list, int repeats, FILE *out, int *first) {
+    Solver solver;
+    int i, r, count = 0, inexact = 0, overBudget = 0;
+    long long states = 0;
+    volatile double sink = 0;
+
+    double *times = malloc((list->count + 1) * sizeof(double));
+    if (!times || !initSolver(&solver, mode->rows, mode->cols)) {
+        fprintf(stderr, "Failed to set up the %s benchmark\n", mode->name);
+        free(times);
+        return;
+    }
+
+    for (i = 0; i < list->count; i++) {
+        const MineField *field = &list->fields[i];
+        if (field->rows != mode->rows || field->cols != mode->cols || field->numMines != mode->numMines) continue;
+
+        solveMineField(&solver, field);  // Warm up the caches and the solver buffers
+        double start = nowNanoseconds();
+        for (r = 0; r < repeats; r++) {
+            solveMineField(&solver, field);
+            sink += solver.probability[0];
+        }
+        double elapsed = (nowNanoseconds() - start) / repeats;
+
+        times[count++] = elapsed;
+        states += solver.states;
+        inexact += !solver.exact;
+        overBudget += elapsed > FRAME_BUDGET_NS;
+    }
+
+    if (count > 0) {
+        TimeStats stats = summarizeTimes(times, count);
+        fprintf(out, "%s\n    {\"mode\": \"%s\", \"rows\": %d, \"cols\": %d, \"mines\": %d, \"positions\": %d, ",
+                *first ? "" : ",", mode->name, mode->rows, mode->cols, mode->numMines, count);
+        writeTimeStats(out, "", &stats);
+        fprintf(out, ", \"avg_states\": %.1f, \"over_frame_budget\": %d, \"inexact\": %d}",
+                (double)states / count, overBudget, inexact);
+        *first = 0;
+
+        fprintf(stderr, "%-8s %6d positions  mean %10.0f ns  p99 %10.0f ns  max %10.0f ns  over budget %d  inexact %d\n",
+                mode->name, count, stats.mean, stats.p99, stats.max, overBudget, inexact);
+    }
+
+    freeSolver(&solver);
+    free(times);
+}
+
+int main(int argc, char *argv[]) {
+    const char *outputFile = NULL;
+    const char *recordFile = NULL;
+    const char *positionFile = NULL;
+    int games = 200;
+    int quick = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (strcmp(argv[i], "--positions") == 0 && i + 1 < argc) {
+            positionFile = argv[++i];
+        } else {
+            outputFile = argv[i];
+        }
+    }
+    if (quick) {
+        games = games < 20 ? games : 20;
+    }
+
+    PositionList list = {NULL, 0, 0};
+    if (positionFile) {
+        if (!readPositions(&list, positionFile)) {
+            fprintf(stderr, "Failed to read the positions\n");
+            return 1;
+        }
+    } else {
+        for (i = 0; i < NUM_MODE_PRESETS; i++) {
+            if (!recordPositions(&modePresets[i], games, &list)) {
+                fprintf(stderr, "Failed to record the %s positions\n", modePresets[i].name);
+                return 1;
+            }
+        }
+        if (recordFile && !writePositions(&list, recordFile)) {
+            return 1;
+        }
+    }
+
+    FILE *out = openBenchOutput(outputFile);
+    if (!out) {
+        return 1;
+    }
+
+    int repeats = quick ? 1 : 10;
+    int first = 1;
+    fprintf(out, "{\n  \"repeats\": %d, \"frame_budget_ns\": %.0f,\n  \"solver\": [", repeats, FRAME_BUDGET_NS);
+    for (i = 0; i < NUM_MODE_PRESETS; i++) {
+        benchmarkMode(&modePresets[i], &list, repeats, out, &first);
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    closeBenchOutput(out);
+    freePositions(&list);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+
+#include <SDL.h>
+
+/**
+ * Cache of the images loaded with loadAndResizeImage, keyed by (path, width, height), so each file is decoded
+ * and rescaled once and the surface is shared by every button, checkbox and cell that shows it. Each holder
+ * takes a reference with acquireImage and gives it back with releaseImage; the surface is freed with its last
+ * reference.
+ */
+
+typedef struct {
+    char *path;              // Copy of the file path
+    int width;
+    int height;
+    SDL_Surface *surface;    // The resized image in the pixel format of the window
+    int refCount;            // Holders of the surface, the entry is removed when it drops to 0
+    int opaque;              // 1 if every pixel of the image is fully opaque
+} AssetCacheEntry;
+
+typedef struct {
+    AssetCacheEntry *entries;
+    int count;
+    int capacity;
+    long hits;
+    long misses;
+} AssetCache;
+
+// Function to get a shared image loaded and resized to the given size (NULL if it couldn't be loaded)
+SDL_Surface* acquireImage(const char *file, int width, int height);
+
+// Function to give back a reference taken with acquireImage (NULL is ignored)
+void releaseImage(SDL_Surface *surface);
+
+// Function to check if a cached image hides everything under it (0 for images the cache doesn't know)
+int isImageOpaque(SDL_Surface *surface);
+
+// Function to read the counters of the cache and the bytes of pixels it keeps in memory
+void getAssetCacheStats(long *hits, long *misses, long *residentBytes);
+
+// Function to free every image still in the cache (at exit)
+void freeAssetCache();
+
+#endif
@@ -5,6 +5,7 @@
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 
+void prepareBackground(SDL_Surface *numbers);
 void renderBackground(SDL_Surface *screen, SDL_Surface *stars, SDL_Surface *numbers);
 void freeBackground(SDL_Surface *stars, SDL_Surface *numbers);
 
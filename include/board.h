@@ -0,0 +1,127 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+#include "rng.h"
+
+/**
+ * Packed board storage. Instead of one 16-byte Cell per square, the board keeps
+ * three bit-planes (mine / revealed / flagged, one bit per cell) and a nibble array
+ * for the adjacent mine count (4 bits per cell), all carved out of one allocation.
+ * Cells are addressed by their linear index (row * cols + col).
+ */
+typedef struct {
+    int rows;                 // Number of rows in the board
+    int cols;                 // Number of columns in the board
+    int planeWords;           // Number of 32-bit words in each bit-plane
+    uint32_t *mines;          // Bit-plane: 1 if the cell contains a mine
+    uint32_t *revealed;       // Bit-plane: 1 if the cell has been revealed
+    uint32_t *flagged;        // Bit-plane: 1 if the cell has been flagged
+    uint8_t *adjacent;        // Adjacent mine counts, two cells per byte (low nibble = even index)
+    int *work;                // Work list of cell indexes used by the flood fill (kept between calls)
+    int workCapacity;         // Number of entries allocated for the work list
+    int *changed;             // Cells revealed or flagged since the log was last reset (NULL when changes aren't tracked)
+    int changedCount;         // Number of cells in the change log
+    int changedOverflow;      // 1 when the log can't tell what changed (cleared board, log full), everything must be redrawn
+} Board;
+
+// Function to allocate a cleared board of the given size (returns 1 on success, 0 on failure)
+int initBoard(Board *board, int rows, int cols);
+
+// Function to reset every cell of the board to covered, unflagged, mine free
+void clearBoard(Board *board);
+
+// Function to free the memory of the board
+void freeBoard(Board *board);
+
+// Function to reveal the opening connected to a cell, returns the number of cells revealed
+int floodRevealBoard(Board *board, int row, int col);
+
+// Function to place mines at random, keeping the first clicked cell and its neighbours free
+int placeBoardMines(Board *board, int numMines, int firstClickRow, int firstClickCol, RandomState *rng);
+
+// Function to compute the adjacent mine count of every cell (mines keep a count of 0)
+void computeAdjacentMines(Board *board);
+
+// Function to count the revealed cells that are not mines
+int countRevealedSafeCells(const Board *board);
+
+// Function to start logging the cells that get revealed or flagged, for a renderer that only redraws those (returns 1 on success)
+int trackBoardChanges(Board *board);
+
+/**CELL ACCESSORS**/
+static inline int cellIndex(const Board *board, int row, int col) {
+    return row * board->cols + col;
+}
+
+static inline int isInsideBoard(const Board *board, int row, int col) {
+    return row >= 0 && row < board->rows && col >= 0 && col < board->cols;
+}
+
+static inline int getBoardBit(const uint32_t *plane, int index) {
+    return (plane[index >> 5] >> (index & 31)) & 1u;
+}
+
+static inline void setBoardBit(uint32_t *plane, int index, int value) {
+    if (value) {
+        plane[index >> 5] |= 1u << (index & 31);
+    } else {
+        plane[index >> 5] &= ~(1u << (index & 31));
+    }
+}
+
+static inline int isMineCell(const Board *board, int row, int col) {
+    return getBoardBit(board->mines, cellIndex(board, row, col));
+}
+
+static inline int isRevealedCell(const Board *board, int row, int col) {
+    return getBoardBit(board->revealed, cellIndex(board, row, col));
+}
+
+static inline int isFlaggedCell(const Board *board, int row, int col) {
+    return getBoardBit(board->flagged, cellIndex(board, row, col));
+}
+
+static inline int getAdjacentMines(const Board *board, int row, int col) {
+    int index = cellIndex(board, row, col);
+    return (board->adjacent[index >> 1] >> ((index & 1) << 2)) & 0x0F;
+}
+
+static inline void setMineCell(Board *board, int row, int col, int value) {
+    setBoardBit(board->mines, cellIndex(board, row, col), value);
+}
+
+static inline void setRevealedCell(Board *board, int row, int col, int value) {
+    setBoardBit(board->revealed, cellIndex(board, row, col), value);
+}
+
+static inline void setFlaggedCell(Board *board, int row, int col, int value) {
+    setBoardBit(board->flagged, cellIndex(board, row, col), value);
+}
+
+/**CHANGE LOG**/
+// Adds a cell to the change log (does nothing when changes aren't tracked)
+static inline void logBoardChange(Board *board, int index) {
+    if (!board->changed) {
+        return;
+    }
+    if (board->changedCount < board->rows * board->cols) {
+        board->changed[board->changedCount++] = index;
+    } else {
+        board->changedOverflow = 1;
+    }
+}
+
+// Empties the change log once the changes have been drawn
+static inline void resetBoardChanges(Board *board) {
+    board->changedCount = 0;
+    board->changedOverflow = 0;
+}
+
+static inline void setAdjacentMines(Board *board, int row, int col, int count) {
+    int index = cellIndex(board, row, col);
+    int shift = (index & 1) << 2;
+    board->adjacent[index >> 1] = (uint8_t)((board->adjacent[index >> 1] & ~(0x0F << shift)) | ((count & 0x0F) << shift));
+}
+
+#endif
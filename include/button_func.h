@@ -14,6 +14,12 @@ SDL_Surface* loadAndResizeImage(const char *file, int width, int height);
 // Function to create a button
 Button createButton(const char *imageFile, const char *text, SDL_Color textColor, int textDirection, float xPercent, float yPercent, int width, int height);
 
+// Function to create a button sized as a share of the window
+Button createScaledButton(const char *imageFile, const char *text, SDL_Color textColor, int textDirection, float xPercent, float yPercent, float widthPercent, float heightPercent);
+
+// Function to place a button again after the window was resized
+void layoutButton(Button *button);
+
 // Function to render a button
 void renderButton(SDL_Surface *screen, Button *button);
 
@@ -27,6 +33,9 @@ int handleButtonClick(Screen* screen, int mouseX, int mouseY);
 // Function to create a checkbox
 CheckBox createCheckbox(const char *imageFileChecked, const char *imageFileNotChecked, const char *text, SDL_Color textColor, int textDirection, float xPercent, float yPercent, int width, int height);
 
+// Function to place a checkbox again after the window was resized
+void layoutCheckbox(CheckBox *checkbox);
+
 // Function to render a checkbox
 void renderCheckbox(SDL_Surface *screen, CheckBox *checkbox);
 
@@ -0,0 +1,23 @@
+#ifndef DIGITATLAS_H
+#define DIGITATLAS_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "struct.h"
+
+// Function to render the digits and ':' of a font into an atlas (returns 1 on success, 0 on failure)
+int buildDigitAtlas(DigitAtlas *atlas, TTF_Font *font);
+
+// Function to make the window format copy of an atlas again (after a video mode change)
+void convertDigitAtlas(DigitAtlas *atlas);
+
+// Function to free the surfaces of an atlas
+void freeDigitAtlas(DigitAtlas *atlas);
+
+// Function to get the width in pixels of a text drawn with an atlas
+int measureDigits(const DigitAtlas *atlas, const char *text);
+
+// Function to draw a text made of digits and ':' with one blit per character
+void drawDigits(SDL_Surface *screen, DigitAtlas *atlas, const char *text, int x, int y, SDL_Color color);
+
+#endif
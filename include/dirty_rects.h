@@ -0,0 +1,16 @@
+#ifndef DIRTYRECTS_H
+#define DIRTYRECTS_H
+
+#include <SDL.h>
+#include "struct.h"
+
+// Function to add a drawn area to the areas pushed to the window at the end of the frame
+void markDirtyRect(DirtyRects *dirty, SDL_Rect rect);
+
+// Function to ask for the whole window to be drawn and flipped this frame
+void markFullRedraw(DirtyRects *dirty);
+
+// Function to push the drawn areas (or the whole window) to the screen and start a new frame
+void presentDirtyRects(DirtyRects *dirty, SDL_Surface *screen);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "board.h"
+#include "rng.h"
+
+/**
+ * Headless game engine: board, mine generation, reveal, flags, win/lose and save/load.
+ * Everything here works on rows and columns only and doesn't depend on SDL, so it is built as its own
+ * static library that the SDL front end links against (and that tools can use without a window).
+ */
+
+// Structure for one cell (layout of each cell record in the save file, the live grid is a packed Board)
+typedef struct {
+    int isMine;           // 1 if the cell contains a mine, 0 otherwise
+    int isRevealed;       // 1 if the cell has been revealed, 0 otherwise
+    int isFlagged;        // 1 if the cell has been flagged as a potential mine
+    int adjacentMines;    // Number of mines in adjacent cells
+} Cell;
+
+// Board size and mine count of a game mode (indexed by GameMode: easy, medium, hard)
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int numMines;
+} ModePreset;
+
+#define NUM_MODE_PRESETS 3
+extern const ModePreset modePresets[NUM_MODE_PRESETS];
+
+// Pool of ready no-guess boards (no_guess.h)
+struct BoardPool;
+
+// Struct to hold the rules side of a game
+typedef struct {
+    int gameState;               // if the game in a win or lose state or still on (stillOn : 0 // lose : 1 // win : 2)
+    int firstClick;              // First click for the user (mines are placed on it)
+    int rows;                    // Number of rows in the grid
+    int cols;                    // Number of columns in the grid
+    int numMines;                // Number of mines based on game mode
+    int flagCount;               // Number of flags
+    int safeCellsLeft;           // Number of safe cells still covered, the player wins when it reaches 0
+    uint64_t seed;               // Seed of the random generator used to place the mines (same seed + first click = same board)
+    Board grid;                  // Packed bit-plane board holding the cells
+    struct BoardPool *pool;      // No-guess boards used by placeMines (NULL places the mines at random)
+} MineField;
+
+// Function to initialize an empty field (returns 1 on success, 0 on failure)
+int initMineField(MineField *field, int rows, int cols, int numMines, uint64_t seed);
+
+// Function to free the memory of the field
+void freeMineField(MineField *field);
+
+// Function to start a new game on an already allocated field (same size and mine count)
+void restartMineField(MineField *field, int numMines, uint64_t seed);
+
+// Function to place the mines, keeping the first clicked cell safe
+void placeMines(MineField *field, int firstClickRow, int firstClickCol);
+
+// Function to calculate the number of adjacent mines of every cell
+void calculateAdjacentMines(MineField *field);
+
+// Function to reveal the opening connected to a cell, returns the number of cells revealed
+int floodFill(MineField *field, int row, int col);
+
+// Function to check if every safe cell has been revealed
+int checkWin(MineField *field);
+
+// Function to reveal a cell as the player would, returns the number of cells revealed
+int revealCell(MineField *field, int row, int col);
+
+// Function to count the 3BV of the field (minimum number of clicks needed to clear it)
+int calculate3BV(MineField *field);
+
+// Function to add or remove a flag on a covered cell, returns 1 if the cell changed
+int toggleFlag(MineField *field, int row, int col);
+
+// Function to write one Cell record per cell to an open save file
+void saveMineFieldCells(MineField *field, FILE *file);
+
+// Function to read the Cell records of an open save file (rows, cols and numMines must already be set)
+int loadMineFieldCells(MineField *field, FILE *file);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FRAMEBANDS_H
+#define FRAMEBANDS_H
+
+#include <SDL.h>
+#include "board.h"
+#include "tile_atlas.h"
+
+/**
+ * Band-parallel drawing of the full-window layers of a frame (background, window panels, grid). While a frame
+ * is recorded, those layers are queued instead of drawn; the queue is drawn when anything else touches the
+ * window (blitSurface flushes it first, so the drawing order is kept) and at the latest right before the frame
+ * is pushed to the screen. A flush cuts the window into one horizontal band per worker thread, every worker
+ * draws all the queued layers clipped to its band, and the flush waits for every band before it returns.
+ * Workers only ever draw through their own SDL_Surface views of the window and of the sources, made and freed
+ * by the main thread, so no SDL state is shared between threads.
+ * A queued source must not be changed or freed before the flush.
+ */
+
+// Function to start the worker threads (0 or less uses every core, 1 draws everything on the calling thread)
+int initFrameBands(int workers);
+
+// Function to get the number of bands a frame is cut into (1 when drawing isn't parallel)
+int getFrameBandCount(void);
+
+// Function to start recording the layers drawn on a window surface
+void beginFrameBands(SDL_Surface *window);
+
+// Function to draw a surface on the window in bands, or right away when no frame of that surface is recorded
+void bandBlit(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *destination, SDL_Rect *destinationRect);
+
+// Function to queue the grid drawn with compositeGrid, clipped to an area (returns 0 if it wasn't queued)
+int queueBandGrid(SDL_Surface *destination, TileAtlas *atlas, const Board *board, int originX, int originY, SDL_Rect clip);
+
+// Function to draw the queued layers before a blit reads or writes the recorded window
+void flushBandsBefore(SDL_Surface *source, SDL_Surface *destination);
+
+// Function to draw the queued layers in parallel bands and wait for every band (the frame stays recorded)
+void flushFrameBands(void);
+
+// Function to draw the queued layers and stop recording
+void endFrameBands(void);
+
+// Function to stop the worker threads
+void freeFrameBands(void);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <SDL.h>
+
+// Frames per second of the animated screens when no --fps option is given
+#define DEFAULT_TARGET_FPS 60
+
+// Longest wait for an event when nothing animates (the loop still wakes up now and then)
+#define IDLE_WAIT_MS 1000
+
+// Struct to pace the main loop
+typedef struct {
+    int targetFps;          // Frames per second while something animates (0 : no cap)
+    double nextFrame;       // SDL_GetTicks time at which the next animated frame is due
+    int animating;          // 1 if the last frame was paced by the frame rate, 0 if it waited for an event
+    int windowVisible;      // 0 while the window is iconified
+    int windowFocused;      // 0 while the window doesn't have the input focus
+} FrameScheduler;
+
+// Function to set up the scheduler with a target frame rate
+void initFrameScheduler(FrameScheduler *scheduler, int targetFps);
+
+// Function to track the window state from SDL_ACTIVEEVENT (returns 1 if the window became visible again)
+int handleSchedulerEvent(FrameScheduler *scheduler, SDL_Event *event);
+
+// Function to wait for the next frame: its deadline if the screen animates, otherwise an event or the wakeup time
+void waitForNextFrame(FrameScheduler *scheduler, int screenAnimates, Uint32 wakeupMs);
+
+#endif
@@ -6,12 +6,30 @@
 #include <SDL_image.h>
 #include "struct.h"
 
+// Function called with the index of every achievement that gets unlocked
+typedef void (*AchievementUnlockedHandler)(void *context, int index);
+
 // Function to initialize the game
 void initializeGame(Game *game);
 
 // Function to draw the grid
 void drawGrid(SDL_Surface *screen, Game *game) ;
 
+// Function to draw only the cells and the timer that changed since the last frame
+void drawGridChanges(SDL_Surface *screen, Game *game);
+
+// Function to convert the cell images to the pixel format of the window after a video mode change
+void convertGameAssets(Game *game);
+
+// Function to move the view of the grid to its part of the window after a resize
+void resizeGameView(Game *game);
+
+// Function to zoom the grid in (direction 1) or out (-1) around a window position (returns 1 if it changed)
+int zoomGameView(Game *game, int direction, int anchorX, int anchorY);
+
+// Function to scroll a grid larger than the window (returns 1 if it moved)
+int panGameView(Game *game, int dx, int dy);
+
 // Function to handle each cell click
 void handleCellClick(Game *game, int mouseX, int mouseY, PlayerStats *playerStats);
 
@@ -29,8 +47,14 @@ void saveAchievementsToFile(Achievement achievements[], int totalAchievements, P
 // Function to load achievements from file
 void loadAchievementsFromFile(Achievement achievements[], int totalAchievements, PlayerStats *playerStats);
 
+// Function to set up the achievements and the stats of a new player
+void initializeAchievements(Achievement achievements[], PlayerStats *playerStats);
+
 void checkAchievements(Achievement achievements[], PlayerStats playerStats, Game game);
 
+// Function to set the function told about the achievements checkAchievements unlocks
+void setAchievementUnlockedHandler(AchievementUnlockedHandler handler, void *context);
+
 // Function to free allocated memory for the grid
 void freeGameGrid(Game *game) ;
 
@@ -0,0 +1,67 @@
+#ifndef NO_GUESS_H
+#define NO_GUESS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "engine.h"
+#include "solver.h"
+
+/**
+ * No-guess boards: boards that can be cleared from the first click by deduction alone (the solver always finds
+ * a proven safe cell). Candidates are generated in parallel on every core with parallelFor, and a pool of ready
+ * boards per mode is kept on disk and refilled by a background thread, so the first click doesn't wait for one.
+ *
+ * A pooled board can be used for every first click that lands on a zero cell of an opening it is solvable from.
+ * The pool also tries the mirror images of each board (and the rotations on square boards), so most clicks find
+ * a board at once. When none fits, placeMines generates one on the spot.
+ */
+
+// Number of boards the refill thread keeps in each pool
+#define BOARD_POOL_TARGET 16
+
+// Candidates tried before giving up and placing the mines at random
+#define NO_GUESS_MAX_CANDIDATES 200000
+
+typedef struct BoardPool {
+    int rows;
+    int cols;
+    int numMines;
+    int planeWords;            // Words of one bit-plane of a board of this size
+    uint32_t *entries;         // Per board: mine plane, then the plane of the cells it can start from
+    int count;
+    int capacity;
+    int target;                // Number of boards the refill thread keeps ready
+    int workers;               // Threads used to generate the candidates of one board
+    const char *filename;      // File the pool is loaded from and saved to
+    RandomState rng;           // Picks the start cell and the candidate seeds of the boards the refill thread makes
+    long hits;                 // First clicks served from the pool
+    long misses;               // First clicks that had to generate a board on the spot
+    pthread_mutex_t lock;
+    pthread_cond_t wake;       // Signalled when a board is taken or the refill thread must stop
+    pthread_t thread;
+    int running;               // 1 while the refill thread runs
+    int stopping;              // Asks the refill thread to stop
+} BoardPool;
+
+// Function to check if a field with its mines placed can be cleared from a cell without guessing
+int isSolvableWithoutGuessing(MineField *field, Solver *solver, int row, int col);
+
+// Function to place no-guess mines on the board for a first click (returns 1 on success, 0 if none was found)
+int generateNoGuessMines(Board *board, int numMines, int firstClickRow, int firstClickCol, uint64_t seed, int workers);
+
+// Function to set up a pool and load its boards from its file (returns 1 on success, 0 on failure)
+int initBoardPool(BoardPool *pool, int rows, int cols, int numMines, const char *filename);
+
+// Function to start the background thread that keeps the pool filled
+int startBoardPoolRefill(BoardPool *pool, int workers);
+
+// Function to place the mines of a pooled board that fits the first click (returns 1 if one was found)
+int takePooledBoard(BoardPool *pool, Board *board, int firstClickRow, int firstClickCol);
+
+// Function to write the boards of the pool to its file
+int saveBoardPool(BoardPool *pool);
+
+// Function to stop the refill thread, save the pool and free its memory
+void freeBoardPool(BoardPool *pool);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * Small explicit-state pseudo random number generator (xoshiro256**).
+ * The whole state lives in the struct, so a board can be regenerated from its 64-bit seed
+ * and several generators can run side by side without sharing anything.
+ */
+typedef struct {
+    uint64_t state[4];
+} RandomState;
+
+// Function to seed the generator from a 64-bit seed
+void seedRandom(RandomState *rng, uint64_t seed);
+
+// Function to get the next 64-bit random number
+uint64_t nextRandom(RandomState *rng);
+
+// Function to get a uniform random number in [0, bound)
+uint32_t randomBelow(RandomState *rng, uint32_t bound);
+
+// Function to make a seed from the current time (for games that don't ask for a specific seed)
+uint64_t makeRandomSeed(void);
+
+#endif
@@ -19,9 +19,24 @@ Screen* createGameOverScreen();
 
 Screen* createAchievementScreen(Achievement achievements[], int totalAchievements);
 
+// Function to tick the checkbox of an unlocked achievement on the achievements screen
+void markAchievementUnlocked(void *achievementScreen, int index);
+
 Screen* createSettingsScreen();
 
-void displayBestThreeTimes(SDL_Surface *screen);
+// Function to set up the board of the chosen mode and ask for a new game (the play button of the mode screen)
+void openGame();
+
+// Function to read the three best times from time.dat (returns 1 on success, 0 on failure)
+int loadBestThreeTimes(Uint32 times[3]);
+
+void displayBestThreeTimes(SDL_Surface *screen, const Uint32 values[3]);
+
+// Function to place the widgets of a screen again after the window was resized
+void layoutScreen(Screen *screen);
+
+// Function to check if a screen hides the whole window under an opaque panel
+int coversWindow(Screen *screen);
 
 // Function to render any screen
 void renderScreen(Screen *Screen, SDL_Surface *screen);
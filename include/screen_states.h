@@ -0,0 +1,61 @@
+#ifndef SCREENSTATES_H
+#define SCREENSTATES_H
+
+#include <SDL.h>
+#include "struct.h"
+
+/**
+ * The screens of the game as a state machine. Each screen index (the values of currentScreen) has a set of
+ * callbacks: onEnter and onExit run once when the game switches to and away from the screen (one-shot work
+ * like reading files or picking images), render draws the whole screen over the background, update draws what
+ * changed since the last frame on screens that aren't redrawn in full every frame, and handleClick gets the
+ * mouse clicks (handleMotion and handleKey, the mouse moves and the key presses, are NULL on screens that
+ * don't use them). The button callbacks still ask for another screen by setting currentScreen, and the main loop
+ * switches to it with applyScreenChange.
+ */
+
+// Number of screen indexes (0 menu, 1 continued game, 2 modes, 3 achievements, 4 new game, 5 game over, 6 settings)
+#define NUM_SCREENS 7
+
+// Everything the screen callbacks work on, owned by the main loop
+typedef struct {
+    SDL_Surface *window;
+    Screen *menuScreen;
+    Screen *modeScreen;
+    Screen *gameScreen;
+    Screen *gameOverScreen;
+    Screen *settingsScreen;
+    Screen *achievementScreen;
+    Game *game;
+    Achievement *achievements;
+    PlayerStats *playerStats;
+    Uint32 bestTimes[3];         // Best times shown by the game over screen, read when it opens
+    int bestTimesLoaded;         // 1 if bestTimes could be read
+    int skipBestTimes;           // 1 to leave the best times of the player out (the headless tools)
+} ScreenContext;
+
+typedef struct {
+    const char *name;
+    int animated;                                          // 1 if the screen is redrawn in full on every frame
+    void (*onEnter)(ScreenContext *context);
+    void (*onExit)(ScreenContext *context);
+    void (*update)(ScreenContext *context);                // Draws the changes of a screen that isn't animated
+    void (*render)(ScreenContext *context);                // Draws the whole screen over the background
+    void (*handleClick)(ScreenContext *context, int mouseX, int mouseY, int button);
+    void (*handleMotion)(ScreenContext *context, int moveX, int moveY, Uint8 buttons);   // Relative mouse move
+    void (*handleKey)(ScreenContext *context, SDLKey key);
+} ScreenState;
+
+// Callbacks of each screen index
+extern const ScreenState screenStates[NUM_SCREENS];
+
+// Function to check if a screen hides the whole window, so the background doesn't need to be drawn under it
+int hidesBackground(ScreenContext *context, int screen);
+
+// Function to leave a screen and enter another one (from < 0 when no screen was active yet)
+void switchScreen(ScreenContext *context, int from, int to);
+
+// Function to switch to the screen asked for in currentScreen, if it changed (returns the active screen)
+int applyScreenChange(ScreenContext *context, int activeScreen);
+
+#endif
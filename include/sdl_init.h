@@ -9,10 +9,16 @@
 // Function to initialize SDL and set up the window
 void initialize_sdl(SDL_Surface **window);
 
+// Function to initialize SDL with an offscreen window (dummy video driver) for the headless tools
+int initializeHeadlessSdl(SDL_Surface **window);
+
 // Function to initialize SDL font using the SDL_ttf library and clean it
 void cleanupFonts();
 void initializeFonts(const char *fontPath) ;
 
+// Time without resize events after which the last size is applied (a drag-resize sends many of them)
+#define RESIZE_SETTLE_MS 100
+
 // Function to handle window resizing
 void resize_window(SDL_Surface **window, SDL_Event event);
 
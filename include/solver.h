@@ -0,0 +1,82 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdint.h>
+#include "engine.h"
+
+/**
+ * Minesweeper solver working on what the player can see: revealed cells and their numbers (the mine plane is never
+ * read and flags are ignored, since they may be wrong). It applies the trivial rules first, then splits the
+ * remaining frontier into independent components, counts the solutions of every component and weights them by the
+ * number of ways the remaining mines fit in the cells no number touches. The result is the exact probability
+ * of a mine in every covered cell.
+ * All the scratch memory is kept in the Solver between calls, so solving after every click doesn't allocate.
+ */
+
+// What the solver knows about a cell
+#define SOLVER_UNKNOWN 0
+#define SOLVER_SAFE 1
+#define SOLVER_MINE 2
+#define SOLVER_REVEALED 3
+
+// Maximum number of counting states x mine totals for one component before it is treated as unconstrained
+#define SOLVER_STATE_BUDGET (1L << 21)
+
+// One way out of a counting state: the next cell gets `mine`, which leads to the state with `key`
+typedef struct {
+    uint64_t key;
+    int from;
+    int mine;
+} SolverTransition;
+
+typedef struct {
+    int rows;
+    int cols;
+    double *probability;       // Probability of a mine in each cell (0 for revealed cells)
+    uint8_t *state;            // SOLVER_* state of each cell after the deductions
+    int knownSafe;             // Number of covered cells proven safe
+    int knownMines;            // Number of covered cells proven to be mines
+    int components;            // Number of independent frontier components counted
+    int exact;                 // 1 if every component was counted, 0 if one went over the state budget
+    long states;               // Number of counting states of the last solve
+
+    // Scratch memory kept between calls
+    int *cellConstraint;       // Index of the constraint of a revealed number, -1 for other cells
+    int *frontierId;           // Index of a frontier cell in the frontier list, -1 for other cells
+    int *queue;                // Work list of the trivial rules, then the frontier cells in discovery order
+    int *frontier;             // Covered cells touching a constraint, grouped by component
+    int *componentInfo;        // Start, size, offset in counts and mine limit of each component (4 ints each)
+    int *constraintNeed;       // Mines still needed around each constraint
+    int *constraintLeft;       // Unassigned cells left around each constraint
+    int *constraintFirst;      // Position of the first cell of each constraint in its component
+    int *constraintLast;       // Position of the last cell of each constraint in its component
+    int *constraintWork;       // Mines still needed around each constraint in the state being expanded
+    int *open;                 // Constraints with cells on both sides of the current boundary
+    int *nextOpen;             // Constraints open after the next cell
+    int *boundaryStart;        // Index of the first counting state of each boundary between two cells
+    uint64_t *stateKeys;       // Needs of the open constraints of each state, 4 bits per constraint
+    int *stateNext;            // State reached when the next cell is safe / a mine (-1 when it breaks a number)
+    int stateCapacity;
+    SolverTransition *transitions;
+    int transitionCapacity;
+    double *paths;             // Forward then backward counts of every state for each mine total
+    int pathsCapacity;
+    double *counts;            // Per component solution counts and per cell mine counts for each mine total
+    int countsCapacity;
+    double *mixes;             // Combined mine total distributions of the components
+    int mixesCapacity;
+} Solver;
+
+// Function to allocate a solver for boards of the given size (returns 1 on success, 0 on failure)
+int initSolver(Solver *solver, int rows, int cols);
+
+// Function to free the memory of the solver
+void freeSolver(Solver *solver);
+
+// Function to compute the mine probability of every covered cell of the field (returns 1 on success, 0 on failure)
+int solveMineField(Solver *solver, const MineField *field);
+
+// Function to find the covered, unflagged cell with the lowest mine probability (returns 0 if there is none)
+int findSafestCell(const Solver *solver, const MineField *field, int *row, int *col);
+
+#endif
@@ -6,6 +6,10 @@
 #include <SDL_image.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "engine.h"
+#include "no_guess.h"
+#include "tile_atlas.h"
+#include "viewport.h"
 
 // Global variables
 #define MAX_TEXTINPUT_LENGTH 100
@@ -31,6 +35,8 @@ extern int frameTimer; /** Number of frames since the game started **/
 extern int currentScreen;/**0 : INIT SCREEN / 1 : MENU SCREEN / 2 : LEVELS SCREEN**/
 
 extern GameMode gameMode;
+extern int noGuessMode;                            // 1 if new games use boards that can be cleared without guessing
+extern BoardPool boardPools[NUM_MODE_PRESETS];     // Ready no-guess boards of each mode (refilled in the background)
 
 extern int gameRowsNum;                       // Number of rows in the grid
 extern int gameColsNum;                       // Number of columns in the grid
@@ -39,12 +45,38 @@ extern int cellSize;                                // cell size based on the di
 
 extern TTF_Font *fonts[NUM_FONTS];
 
+// Pre-rendered digits and ':' of one font size, for the timer and the best times (see digit_atlas.c)
+#define DIGIT_ATLAS_GLYPHS 11
+typedef struct {
+    SDL_Surface *master;                   // The glyphs side by side, 8-bit with the text colour in palette entry 1
+    SDL_Surface *surface;                  // Copy of master in the pixel format of the window, in the current colour
+    SDL_Rect glyphs[DIGIT_ATLAS_GLYPHS];   // Area of "0" .. "9" and ":" in the surface
+    SDL_Color color;                       // Colour the palette is currently set to
+} DigitAtlas;
+
+extern DigitAtlas digitAtlases[NUM_FONTS];  // One atlas per entry of fonts
+
+// Parts of the window drawn since the last frame was shown (see dirty_rects.c)
+#define MAX_DIRTY_RECTS 128
+typedef struct {
+    SDL_Rect rects[MAX_DIRTY_RECTS];
+    int count;
+    int fullRedraw;  /** 1 : the whole window is drawn and flipped // 0 : only the rects are pushed **/
+} DirtyRects;
+
+extern DirtyRects dirtyRects;
+
 // Button structure
 typedef struct {
     SDL_Surface *image;
+    const char *imageFile; /** Image the button was created with, resized again when its size changes **/
     SDL_Rect position;
     int width;
     int height;
+    float xPercent; /** Anchors the position is computed from on relayout **/
+    float yPercent;
+    float widthPercent; /** Share of the window width and height the button covers, 0 for a fixed size **/
+    float heightPercent;
     const char *text;
     SDL_Color textColor;
     int textDirection; /**0 : center // 1 : right // -1 : left**/
@@ -59,6 +91,8 @@ typedef struct {
     SDL_Rect position;
     int width;
     int height;
+    float xPercent; /** Anchors the position is computed from on relayout **/
+    float yPercent;
     const char *text;
     SDL_Color textColor;
     int textDirection; /** 0 : center // 1 : right // -1 : left**/
@@ -75,28 +109,15 @@ typedef struct {
     int checkBoxCount;
 } Screen;
 
-// Structure for one cell
-typedef struct {
-    int isMine;           // 1 if the cell contains a mine, 0 otherwise
-    int isRevealed;       // 1 if the cell has been revealed, 0 otherwise
-    int isFlagged;        // 1 if the cell has been flagged as a potential mine
-    int adjacentMines;    // Number of mines in adjacent cells
-} Cell;
-
 // Struct to hold game data
 typedef struct {
-    int gameState;               // if the game in a win or lose state or still on (stillOn : 0 // lose : 1 // win : 2)
-    int firstClick;                  // First click for the user
-    int rows;                       // Number of rows in the grid
-    int cols;                       // Number of columns in the grid
-    int numMines;             // Number of mines based on game mode
-    int flagCount;             // Number of flags
+    MineField field;             // Grid, mines and win/lose state of the game (SDL free engine, see engine.h)
     int cellSize;                // Size of the cell
+    Viewport view;               // Part of the window the grid is drawn in, its zoomed cell size and scroll
     Uint32 startTime;       // time when the game start
     Uint32 elapsedTime;  // time since the game started
     Uint32 pausedTime;  // time when the player pauses the game
-    SDL_Surface **assets; // Images of the game like bomb,numbers and empty cell
-    Cell **grid;                 // Pointer to a 2D array of Cells
+    TileAtlas tiles;    // Images of the game like bomb,numbers and empty cell, in one atlas at the cell size
 } Game;
 // struct for achievement and player stats
 typedef struct {
@@ -0,0 +1,27 @@
+#ifndef SURFACEFORMAT_H
+#define SURFACEFORMAT_H
+
+#include <SDL.h>
+
+// Function to make a copy of a surface in the pixel format of the window (returns NULL on failure)
+SDL_Surface* displayFormatCopy(SDL_Surface *surface);
+
+// Function to replace a surface by its copy in the pixel format of the window (the original is freed)
+SDL_Surface* convertToDisplayFormat(SDL_Surface *surface);
+
+// Function to check if two pixel formats have the same layout (blits between them copy the pixels as they are)
+int isSameFormat(const SDL_PixelFormat *a, const SDL_PixelFormat *b);
+
+// Function to check if every pixel of a surface is fully opaque
+int isOpaqueSurface(SDL_Surface *surface);
+
+// Function to blit a surface and count the blits that have to convert pixels on the way
+int blitSurface(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *destination, SDL_Rect *destinationRect);
+
+// Function to count a blit that didn't go through blitSurface
+void countBlit(SDL_Surface *source, SDL_Surface *destination);
+
+// Function to read the blit counters
+void getBlitStats(long *blits, long *slowBlits);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+/**
+ * Cache of rendered text surfaces keyed by (font, string, colour), so the labels of the widgets are rasterized
+ * once instead of every frame. The least recently used surface is evicted when the cache is full.
+ */
+
+// Number of text surfaces kept in the cache
+#define TEXT_CACHE_SIZE 64
+
+typedef struct {
+    TTF_Font *font;
+    char *text;              // Copy of the string (NULL for a free entry)
+    Uint32 hash;             // Hash of the string, compared before the string itself
+    SDL_Color color;
+    SDL_Surface *surface;
+    Uint32 lastUsed;         // Value of the use counter when the entry was last looked up
+} TextCacheEntry;
+
+typedef struct {
+    TextCacheEntry entries[TEXT_CACHE_SIZE];
+    Uint32 useCounter;       // Incremented on every lookup, orders the entries for the LRU eviction
+    long hits;
+    long misses;
+    long evictions;
+} TextCache;
+
+// Function to get the surface of a text (owned by the cache: blit it right away and never free it)
+SDL_Surface* getTextSurface(TTF_Font *font, const char *text, SDL_Color color);
+
+// Function to read the counters of the cache
+void getTextCacheStats(long *hits, long *misses, long *evictions);
+
+// Function to convert the cached surfaces to the pixel format of the window after a video mode change
+void convertTextCache();
+
+// Function to free every surface of the cache (before the fonts are closed)
+void freeTextCache();
+
+#endif
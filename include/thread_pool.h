@@ -0,0 +1,20 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * Work-stealing parallel loop for the headless tools (self-play, board generation).
+ * The range [0, count) is cut into chunks and every worker starts with its own run of chunks.
+ * A worker takes chunks from the front of its own run, and when it runs out it steals from the
+ * back of the busiest other run, so uneven chunks (long games, hard boards) still keep all cores busy.
+ */
+
+// Task run on one chunk: worker is the index of the thread (0 .. workers - 1), [begin, end) the items of the chunk
+typedef void (*ParallelTask)(void *context, int worker, long begin, long end);
+
+// Function to get the number of cores available to the process
+int getCoreCount(void);
+
+// Function to run task over [0, count) in chunks on the given number of workers (returns 1 on success, 0 on failure)
+int parallelFor(long count, long chunkSize, int workers, ParallelTask task, void *context);
+
+#endif
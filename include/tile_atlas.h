@@ -0,0 +1,42 @@
+#ifndef TILEATLAS_H
+#define TILEATLAS_H
+
+#include <SDL.h>
+#include "board.h"
+
+/**
+ * The 12 cell images of the game side by side in one surface at the current cell size, in the pixel format of
+ * the window, and a grid compositor that draws a whole board from it by copying rows of tile pixels with memcpy
+ * instead of blitting every cell on its own. No SDL_ttf or SDL_image here, so the render benchmark can use it.
+ */
+
+// Tiles of the atlas, in this order: digits 1 to 8 (tile = count - 1), then these
+#define TILE_COUNT 12
+#define TILE_COVERED 8
+#define TILE_EMPTY 9
+#define TILE_BOMB 10
+#define TILE_FLAG 11
+
+typedef struct {
+    SDL_Surface *surface;    // TILE_COUNT tiles of size x size pixels side by side (NULL before the first build)
+    int size;                // Width and height of a tile, the cell size it was built for
+    int *rowTiles;           // Tile of each cell of the row being composited
+    int rowCapacity;
+} TileAtlas;
+
+// Function to build the atlas from the 12 cell images at a size, in the format of a target surface
+int buildTileAtlas(TileAtlas *atlas, SDL_Surface *tiles[TILE_COUNT], int size, SDL_Surface *target);
+
+// Function to free the atlas
+void freeTileAtlas(TileAtlas *atlas);
+
+// Function to get the tile that shows a cell in its current state
+int cellTile(const Board *board, int row, int col);
+
+// Function to draw one tile with a blit
+void drawTile(SDL_Surface *screen, const TileAtlas *atlas, int tile, int x, int y);
+
+// Function to draw every cell of a board, with its top left corner at (originX, originY)
+void compositeGrid(SDL_Surface *screen, TileAtlas *atlas, const Board *board, int originX, int originY);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef TILELEVELS_H
+#define TILELEVELS_H
+
+#include <SDL.h>
+#include "tile_atlas.h"
+
+/**
+ * Pre-scaled copies of the cell images: every image is decoded once and kept at power-of-two sizes from
+ * TILE_LEVEL_MAX_SIZE down to TILE_LEVEL_MIN_SIZE (each level a 2x2 box average of the one above, with an SSE2
+ * path). A tile at any cell size is then made from the nearest level at or above that size with one bilinear
+ * step, so changing the cell size (new mode, zoom, video mode) never decodes or stretches the files again.
+ * The levels are 32-bit ARGB whatever the window format; the tiles are converted when the atlas is built.
+ */
+
+#define TILE_LEVEL_MAX_SIZE 128
+#define TILE_LEVEL_MIN_SIZE 8
+#define TILE_LEVELS 5                      // 128, 64, 32, 16, 8
+
+typedef struct {
+    SDL_Surface *levels[TILE_COUNT][TILE_LEVELS];   // Tile t at TILE_LEVEL_MAX_SIZE >> l pixels (NULL if not set)
+} TileLevels;
+
+// Function to build the levels of a tile from its decoded image (the image is left untouched)
+int setTileImage(TileLevels *levels, int tile, SDL_Surface *image);
+
+// Function to check if a tile has its levels
+int hasTileLevels(const TileLevels *levels, int tile);
+
+// Function to make a tile at a size from its nearest level (returns a new surface, NULL if the tile has no levels)
+SDL_Surface* scaleTile(const TileLevels *levels, int tile, int size);
+
+// Function to free every level
+void freeTileLevels(TileLevels *levels);
+
+#endif
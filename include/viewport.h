@@ -0,0 +1,49 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include <SDL.h>
+
+/**
+ * Camera over the grid: the part of the window the grid is drawn in, the zoomed cell size and how far the grid
+ * is scrolled in it. Drawing and hit testing both go through it, so boards larger than the window can be panned
+ * and zoomed, and only the cells inside the area are drawn.
+ */
+
+// Smallest and largest cell size the grid can be zoomed to
+#define MIN_VIEW_CELL_SIZE 8
+#define MAX_VIEW_CELL_SIZE 80
+
+typedef struct {
+    SDL_Rect area;    // Part of the window the grid is drawn in
+    int rows;
+    int cols;
+    int cellSize;     // Size of a cell at the current zoom
+    int scrollX;      // Pixel of the grid at the left edge of the area (negative when the grid is centred in it)
+    int scrollY;      // Pixel of the grid at the top edge of the area (negative when the grid sits at its bottom)
+} Viewport;
+
+// Function to point the viewport at a grid, with the grid centred in the area
+void initViewport(Viewport *viewport, SDL_Rect area, int rows, int cols, int cellSize);
+
+// Function to move the viewport to another area of the window, keeping the zoom and the scroll where possible
+void setViewportArea(Viewport *viewport, SDL_Rect area);
+
+// Function to get the window position of the top left corner of the grid
+void getViewportOrigin(const Viewport *viewport, int *x, int *y);
+
+// Function to get the cell under a window position (returns 0 outside the area or the grid)
+int viewportCellAt(const Viewport *viewport, int x, int y, int *row, int *col);
+
+// Function to get the part of the window where cells are drawn (the grid clipped to the area)
+SDL_Rect visibleGridArea(const Viewport *viewport);
+
+// Function to clip a rect of the window to the visible part of the grid (returns 0 if nothing is left)
+int clipToViewport(const Viewport *viewport, SDL_Rect *rect);
+
+// Function to scroll the grid by a number of pixels (returns 1 if it moved)
+int panViewport(Viewport *viewport, int dx, int dy);
+
+// Function to change the cell size, keeping the grid point under (anchorX, anchorY) in place (returns 1 if it changed)
+int zoomViewport(Viewport *viewport, int cellSize, int anchorX, int anchorY);
+
+#endif
@@ -5,6 +5,7 @@
  **/
 
 #include <stdio.h>
+#include <string.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
@@ -15,24 +16,14 @@
 #include "include/button_func.h"
 #include "include/background_renderer.h"
 #include "include/game_manager.h"
-
-// Global variables definition
-int screenWidth = 1100;  // Width of the window
-int screenHeight = 700;  // Height of the window
-
-int currentScreen = 0;  // Tracks the current screen (0: menu, 1: game, etc.)
-GameState gameState = GAME_ON;  // Initial game state is "on"
-int frameTimer = 0;  // Timer for controlling frame rate
-GameMode gameMode = MODE_EASY;  // Default game mode is easy
-
-// Game grid and cell size
-int gameRowsNum = 0;
-int gameColsNum = 0;
-int gameMinesNum = 0;
-int cellSize = 1;
-
-// Array to store fonts for rendering text
-TTF_Font *fonts[NUM_FONTS];
+#include "include/dirty_rects.h"
+#include "include/frame_bands.h"
+#include "include/frame_scheduler.h"
+#include "include/text_cache.h"
+#include "include/digit_atlas.h"
+#include "include/surface_format.h"
+#include "include/asset_cache.h"
+#include "include/screen_states.h"
 
 // Main function
 int main(int argc, char *argv[]) {
@@ -40,9 +31,10 @@ int main(int argc, char *argv[]) {
     SDL_Surface *window = NULL;
     initialize_sdl(&window);  // Set up SDL window
 
-    // Initialize background images (stars and numbers)
-    SDL_Surface *stars = IMG_Load("assets/background/star_field.png");
-    SDL_Surface *numbers = IMG_Load("assets/background/numbers.png");
+    // Initialize background images (stars and numbers), in the pixel format of the window
+    SDL_Surface *stars = convertToDisplayFormat(IMG_Load("assets/background/star_field.png"));
+    SDL_Surface *numbers = convertToDisplayFormat(IMG_Load("assets/background/numbers.png"));
+    prepareBackground(numbers);
 
     // Initialize fonts for text rendering
     initializeFonts("assets/fonts/M 8pt.ttf");
@@ -55,122 +47,173 @@ int main(int argc, char *argv[]) {
     PlayerStats playerStats;
     int i;
 
+    // Frame rate of the animated screens (--fps N, 0 for no cap) and threads drawing the frames (--threads N,
+    // 0 for every core, 1 to draw on this thread only)
+    int targetFps = DEFAULT_TARGET_FPS;
+    int drawThreads = 0;
+    for (i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--fps") == 0) {
+            targetFps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            drawThreads = atoi(argv[++i]);
+        }
+    }
+    initFrameBands(drawThreads);
+
     // Load the achievements
     loadAchievementsFromFile(achievements, TOTAL_ACHIEVEMENTS, &playerStats);
 
-    // Initialize different screens (menu, mode, and game)
-    Screen *menuScreen = createMenuScreen();
-    Screen *modeScreen = createModeScreen();
-    Screen *gameScreen = createGameScreen();
-    Screen *gameOverScreen = createGameOverScreen();
-    Screen *settingsScreen = createSettingsScreen();
-    Screen *achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
+    // Initialize different screens (menu, mode, and game), in the state the screen callbacks work on
+    ScreenContext context = {0};
+    context.window = window;
+    context.menuScreen = createMenuScreen();
+    context.modeScreen = createModeScreen();
+    context.gameScreen = createGameScreen();
+    context.gameOverScreen = createGameOverScreen();
+    context.settingsScreen = createSettingsScreen();
+    context.achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
+    context.achievements = achievements;
+    context.playerStats = &playerStats;
+    setAchievementUnlockedHandler(markAchievementUnlocked, &context.achievementScreen);
+
+    // Load the no-guess boards of each mode and keep the pools filled in the background
+    const char *poolFiles[NUM_MODE_PRESETS] = {"board_pool_easy.dat", "board_pool_medium.dat", "board_pool_hard.dat"};
+    for (i = 0; i < NUM_MODE_PRESETS; i++) {
+        if (initBoardPool(&boardPools[i], modePresets[i].rows, modePresets[i].cols, modePresets[i].numMines, poolFiles[i])) {
+            startBoardPoolRefill(&boardPools[i], 1);  // One thread each, so the game keeps the other cores
+        }
+    }
 
     // Initialize the game state
-    Game game;
+    Game game = {0};  // No tile atlas yet, initializeGame builds it
     initializeGame(&game);  // Initialize game logic
     loadGameGrid(&game, "game_data.dat");  // Load previous game data (if any)
+    context.game = &game;
+
+    int activeScreen = currentScreen;  // Screen whose callbacks run, currentScreen is the one asked for
+    switchScreen(&context, -1, activeScreen);
+
+    FrameScheduler scheduler;
+    initFrameScheduler(&scheduler, targetFps);
+
+    SDL_Event pendingResize;  // Last resize event, applied once no other one came for RESIZE_SETTLE_MS
+    int resizePending = 0;
+    Uint32 lastResizeTime = 0;
 
     // Main game loop
     while (gameState) {
+        // Wait for the next frame: the game screen only changes on events and when its timer ticks,
+        // the other screens scroll their background at the target frame rate
+        int animated = screenStates[activeScreen].animated;
+        Uint32 wakeup = animated ? IDLE_WAIT_MS : 1000 - (SDL_GetTicks() - game.startTime) % 1000;
+        if (resizePending) {
+            Uint32 settled = SDL_GetTicks() - lastResizeTime;
+            Uint32 left = settled < RESIZE_SETTLE_MS ? RESIZE_SETTLE_MS - settled : 0;
+            wakeup = left < wakeup ? left : wakeup;  // Wake up in time to apply the last size
+        }
+        waitForNextFrame(&scheduler, animated, wakeup);
+
         frameTimer++;  // Increment frame timer for each loop
-        renderBackground(window, stars, numbers);  // Render the background
 
         // Handle user events (keyboard, mouse, and window resizing)
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {  // If the user closes the window
                 gameState = GAME_OFF;  // End the game
-            } else if (event.type == SDL_VIDEORESIZE) {  // If the window is resized
-                // Handle window resizing and recreate screens based on new size
-                resize_window(&window, event);
-                menuScreen = createMenuScreen();
-                modeScreen = createModeScreen();
-                gameScreen = createGameScreen();
-                settingsScreen = createSettingsScreen();
-                gameOverScreen = createGameOverScreen();
-                achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
-            } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {  // If left mouse button is clicked
-                int mouseX = event.button.x;  // Get mouse X position
-                int mouseY = event.button.y;  // Get mouse Y position
-
-                // Handle button clicks based on the current screen
-                if(currentScreen == 0) {
-                    handleButtonClick(menuScreen, mouseX, mouseY);  // Main menu button click
-                    if(currentScreen == 1 && game.gameState != 0){ // if the player already lost the previous game don't open it
-                        currentScreen = 0;
-                    }
-                }
-                if(currentScreen == 2) {  // Mode screen button clicks
-                    if (handleButtonClick(modeScreen, mouseX, mouseY)) {
-                        if(currentScreen==4){
-                            initializeGame(&game);  // Initialize the game when play button is clicked
-                        }
-                    }
-                    handleCheckBoxClick(modeScreen, mouseX, mouseY);  // Handle checkbox clicks (game modes)
-                }
-                if(currentScreen == 3) {
-                    handleButtonClick(achievementScreen, mouseX, mouseY);
-                }
-                if(currentScreen == 4 || currentScreen == 1) {  // Game screen cell clicks
-                    handleCellClick(&game, mouseX, mouseY, &playerStats);
-                    handleButtonClick(gameScreen, mouseX, mouseY);
-                }
-                if(currentScreen == 5) {
-                    handleButtonClick(gameOverScreen, mouseX, mouseY);  // game over button click
-                }
-                 if(currentScreen == 6) {
-                    handleButtonClick(settingsScreen, mouseX, mouseY);
-                    handleCheckBoxClick(settingsScreen, mouseX, mouseY);
+            } else if (event.type == SDL_ACTIVEEVENT) {  // If the window is iconified, restored or loses the focus
+                if (handleSchedulerEvent(&scheduler, &event)) {
+                    markFullRedraw(&dirtyRects);
                 }
+            } else if (event.type == SDL_VIDEORESIZE) {  // If the window is resized
+                // A drag-resize sends many events: keep the last size and apply it once they stop coming
+                pendingResize = event;
+                resizePending = 1;
+                lastResizeTime = SDL_GetTicks();
+            } else if (event.type == SDL_VIDEOEXPOSE) {  // If the window has to be repainted
+                markFullRedraw(&dirtyRects);
+            } else if (event.type == SDL_MOUSEBUTTONDOWN) {  // If a mouse button is clicked
+                // Handle the click on the active screen, then switch to the screen it asked for (if any)
+                screenStates[activeScreen].handleClick(&context, event.button.x, event.button.y, event.button.button);
+                activeScreen = applyScreenChange(&context, activeScreen);
+            } else if (event.type == SDL_MOUSEMOTION && screenStates[activeScreen].handleMotion) {  // Mouse drags
+                screenStates[activeScreen].handleMotion(&context, event.motion.xrel, event.motion.yrel, event.motion.state);
+            } else if (event.type == SDL_KEYDOWN && screenStates[activeScreen].handleKey) {  // Key presses
+                screenStates[activeScreen].handleKey(&context, event.key.keysym.sym);
+            }
+        }
+
+        // Resize the window to the last size asked for once the resize events settled
+        if (resizePending && SDL_GetTicks() - lastResizeTime >= RESIZE_SETTLE_MS) {
+            resizePending = 0;
+            SDL_PixelFormat oldFormat = *window->format;
+            resize_window(&window, pendingResize);
+            if (!window) {
+                break;  // The game is turned off, there is no window to draw on
+            }
+            context.window = window;
 
-            }else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_RIGHT) {  // If right mouse button is clicked
-                int mouseX = event.button.x;  // Get mouse X position
-                int mouseY = event.button.y;  // Get mouse Y position
-                if(currentScreen == 4 || currentScreen == 1) {  // Game screen flags click
-                    handleFlagClick(&game, mouseX, mouseY);
+            if (isSameFormat(&oldFormat, window->format)) {
+                // Move the widgets from their anchors, only the images sized on the window are resized
+                layoutScreen(context.menuScreen);
+                layoutScreen(context.modeScreen);
+                layoutScreen(context.gameScreen);
+                layoutScreen(context.settingsScreen);
+                layoutScreen(context.gameOverScreen);
+                layoutScreen(context.achievementScreen);
+                resizeGameView(&game);
+                markFullRedraw(&dirtyRects);
+            } else {
+                // The new video mode has another pixel format, convert the loaded surfaces again.
+                // The old screens are freed first, so the images they shared leave the asset cache and
+                // the new screens load them in the new format
+                freeScreen(context.menuScreen);
+                freeScreen(context.modeScreen);
+                freeScreen(context.gameScreen);
+                freeScreen(context.settingsScreen);
+                freeScreen(context.gameOverScreen);
+                freeScreen(context.achievementScreen);
+                stars = convertToDisplayFormat(stars);
+                numbers = convertToDisplayFormat(numbers);
+                prepareBackground(numbers);
+                convertGameAssets(&game);
+                resizeGameView(&game);
+                convertTextCache();
+                for (i = 0; i < NUM_FONTS; i++) {
+                    convertDigitAtlas(&digitAtlases[i]);
                 }
+
+                context.menuScreen = createMenuScreen();
+                context.modeScreen = createModeScreen();
+                context.gameScreen = createGameScreen();
+                context.settingsScreen = createSettingsScreen();
+                context.gameOverScreen = createGameOverScreen();
+                context.achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
+                switchScreen(&context, activeScreen, activeScreen);  // Set the new screens up again
             }
         }
 
-        // Render the appropriate screen based on the current screen
-        switch(currentScreen) {
-            case 0:  // Main menu screen
-                renderScreen(menuScreen, window);
-                break;
-            case 1:  // Game grid screen
-                renderScreen(gameScreen, window);
-                drawGrid(window, &game);
-                break;
-            case 2:  // Mode selection screen
-                renderScreen(modeScreen, window);
-                break;
-            case 3:
-                achievementScreen = createAchievementScreen(achievements, TOTAL_ACHIEVEMENTS);
-                renderScreen(achievementScreen, window);
-                break;
-            case 4:  // Game screen (after selecting a mode)
-                renderScreen(gameScreen, window);
-                drawGrid(window, &game);
-                break;
-            case 5:
-                if(game.gameState==1){
-                    SDL_Color textColorGrey = { 70, 70, 70 };
-                    gameOverScreen->buttons[2] = createButton("assets/images/youlose.png", "", textColorGrey, 0, .5, .2, 300, 169);
-                }
+        if (!scheduler.windowVisible) {
+            continue;  // Nothing to draw while the window is iconified
+        }
 
-                renderScreen(gameOverScreen, window);
-                displayBestThreeTimes(window);
-                checkAchievements(achievements, playerStats, game) ;
+        // A screen that isn't animated only redraws what changed once it has been drawn in full
+        const ScreenState *state = &screenStates[activeScreen];
+        if (!state->animated && !dirtyRects.fullRedraw) {
+            state->update(&context);
+            presentDirtyRects(&dirtyRects, window);
+            continue;
+        }
 
-                break;
-            case 6: // Settings screen
-                renderScreen(settingsScreen, window);
-                break;
+        // Every other frame redraws the whole window, the full-window layers in parallel bands
+        markFullRedraw(&dirtyRects);
+        beginFrameBands(window);
+        if (!hidesBackground(&context, activeScreen)) {
+            renderBackground(window, stars, numbers);  // Render the background (unless a full window panel hides it)
         }
+        state->render(&context);  // Render the active screen
 
         // Update the window
-        SDL_Flip(window);  // Update the window with rendered content
+        presentDirtyRects(&dirtyRects, window);  // Update the window with rendered content
     }
 
     // Save the game grid to file when exiting
@@ -178,20 +221,40 @@ int main(int argc, char *argv[]) {
     //save the achievements
     saveAchievementsToFile(achievements, TOTAL_ACHIEVEMENTS, &playerStats);
 
+    long assetHits, assetMisses, assetBytes;
+    getAssetCacheStats(&assetHits, &assetMisses, &assetBytes);
+    printf("Asset cache: %ld hits, %ld misses (%.1f%% hit rate), %ld bytes resident\n", assetHits, assetMisses,
+           assetHits + assetMisses ? 100.0 * assetHits / (assetHits + assetMisses) : 0.0, assetBytes);
+
     // Free resources (background images, screens, game grid, etc.)
     freeBackground(stars, numbers);
-    freeScreen(menuScreen);
-    freeScreen(modeScreen);
-    freeScreen(gameScreen);
-    freeScreen(gameOverScreen);
-    freeScreen(achievementScreen);
-    freeScreen(settingsScreen);
+    freeScreen(context.menuScreen);
+    freeScreen(context.modeScreen);
+    freeScreen(context.gameScreen);
+    freeScreen(context.gameOverScreen);
+    freeScreen(context.achievementScreen);
+    freeScreen(context.settingsScreen);
     freeGameGrid(&game);
+    freeFrameBands();
+    freeAssetCache();  // Frees what is left (nothing, unless a reference leaked)
+    for (i = 0; i < NUM_MODE_PRESETS; i++) {
+        freeBoardPool(&boardPools[i]);  // Waits for the refill thread and saves the pool
+    }
 
     //Free sound
     Mix_FreeMusic(MainMusic);
     Mix_CloseAudio();
 
+    // Free the cached text surfaces before the fonts they were rendered with
+    long textHits, textMisses, textEvictions;
+    getTextCacheStats(&textHits, &textMisses, &textEvictions);
+    printf("Text cache: %ld hits, %ld misses, %ld evictions\n", textHits, textMisses, textEvictions);
+    freeTextCache();
+
+    long blits, slowBlits;
+    getBlitStats(&blits, &slowBlits);
+    printf("Blits: %ld, %ld converting pixels\n", blits, slowBlits);
+
     // Cleanup and quit SDL and SDL_image
     cleanupFonts();
     IMG_Quit();
@@ -0,0 +1,166 @@
+#include "../include/asset_cache.h"
+#include "../include/button_func.h"
+#include "../include/surface_format.h"
+#include <SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Entries allocated the first time the cache grows (doubled afterwards)
+#define ASSET_CACHE_INITIAL_CAPACITY 32
+
+// Images shared by the screens and the game (one cache for the whole game)
+static AssetCache assetCache;
+
+/**
+ * Makes room for one more entry, doubling the array when it is full.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if the memory couldn't be allocated.
+ */
+static int growAssetCache() {
+    if (assetCache.count < assetCache.capacity) {
+        return 1;
+    }
+
+    int capacity = assetCache.capacity ? assetCache.capacity * 2 : ASSET_CACHE_INITIAL_CAPACITY;
+    AssetCacheEntry *entries = realloc(assetCache.entries, capacity * sizeof(AssetCacheEntry));
+    if (!entries) {
+        printf("Memory allocation failed for the asset cache\n");
+        return 0;
+    }
+    assetCache.entries = entries;
+    assetCache.capacity = capacity;
+    return 1;
+}
+
+/**
+ * Returns an image loaded from a file and resized to the given size, shared with every other holder of the same
+ * (path, width, height). The first request decodes and resizes the file with loadAndResizeImage, the next ones
+ * only take another reference on the same surface. Each call must be matched by a releaseImage, and the surface
+ * must not be modified or freed by its holders.
+ *
+ * Parameters:
+ *   - const char *file: Path to the image file.
+ *   - int width: Width of the resized image.
+ *   - int height: Height of the resized image.
+ *
+ * Returns:
+ *   - SDL_Surface*: The shared image, or NULL if it couldn't be loaded (nothing is cached then).
+ */
+SDL_Surface* acquireImage(const char *file, int width, int height) {
+    int i;
+    for (i = 0; i < assetCache.count; i++) {
+        AssetCacheEntry *entry = &assetCache.entries[i];
+        if (entry->width == width && entry->height == height && strcmp(entry->path, file) == 0) {
+            entry->refCount++;
+            assetCache.hits++;
+            return entry->surface;
+        }
+    }
+
+    assetCache.misses++;
+    SDL_Surface *surface = loadAndResizeImage(file, width, height);
+    if (!surface) {
+        return NULL;
+    }
+
+    // Without room to cache it, the caller still gets the image, and releaseImage frees it as an unknown surface
+    char *path = malloc(strlen(file) + 1);
+    if (!path || !growAssetCache()) {
+        if (path) {
+            free(path);
+        } else {
+            printf("Memory allocation failed for the asset cache\n");
+        }
+        return surface;
+    }
+    strcpy(path, file);
+
+    AssetCacheEntry *entry = &assetCache.entries[assetCache.count++];
+    entry->path = path;
+    entry->width = width;
+    entry->height = height;
+    entry->surface = surface;
+    entry->refCount = 1;
+    entry->opaque = isOpaqueSurface(surface);
+    return surface;
+}
+
+/**
+ * Gives back a reference taken with acquireImage. The image is freed and removed from the cache when this was
+ * its last reference. A surface the cache doesn't know is freed right away.
+ *
+ * Parameters:
+ *   - SDL_Surface *surface: The image to release (NULL is ignored).
+ */
+void releaseImage(SDL_Surface *surface) {
+    if (!surface) {
+        return;
+    }
+
+    int i;
+    for (i = 0; i < assetCache.count; i++) {
+        AssetCacheEntry *entry = &assetCache.entries[i];
+        if (entry->surface != surface) continue;
+
+        if (--entry->refCount == 0) {
+            SDL_FreeSurface(entry->surface);
+            free(entry->path);
+            *entry = assetCache.entries[--assetCache.count];  // Move the last entry into the hole
+        }
+        return;
+    }
+    SDL_FreeSurface(surface);
+}
+
+/**
+ * Tells if an image of the cache hides everything drawn under it (checked once, when it was loaded).
+ *
+ * Parameters:
+ *   - SDL_Surface *surface: An image returned by acquireImage.
+ *
+ * Returns:
+ *   - int: 1 if every pixel of the image is fully opaque, 0 otherwise or if the cache doesn't know the image.
+ */
+int isImageOpaque(SDL_Surface *surface) {
+    int i;
+    for (i = 0; i < assetCache.count; i++) {
+        if (assetCache.entries[i].surface == surface) {
+            return assetCache.entries[i].opaque;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reads the counters of the asset cache.
+ *
+ * Parameters:
+ *   - long *hits: Receives the number of images that were already in the cache when they were asked for.
+ *   - long *misses: Receives the number of images that had to be loaded from their file.
+ *   - long *residentBytes: Receives the size of the pixels of the images currently in the cache.
+ */
+void getAssetCacheStats(long *hits, long *misses, long *residentBytes) {
+    int i;
+    *hits = assetCache.hits;
+    *misses = assetCache.misses;
+    *residentBytes = 0;
+    for (i = 0; i < assetCache.count; i++) {
+        *residentBytes += (long)assetCache.entries[i].surface->pitch * assetCache.entries[i].surface->h;
+    }
+}
+
+/**
+ * Frees every image still in the cache, whatever its references, and the cache itself.
+ * Called once at exit, after the screens and the game were freed.
+ */
+void freeAssetCache() {
+    int i;
+    for (i = 0; i < assetCache.count; i++) {
+        SDL_FreeSurface(assetCache.entries[i].surface);
+        free(assetCache.entries[i].path);
+    }
+    free(assetCache.entries);
+    assetCache.entries = NULL;
+    assetCache.count = assetCache.capacity = 0;
+}
@@ -1,12 +1,76 @@
 #include "../include/struct.h"
 #include "../include/background_renderer.h"
+#include "../include/surface_format.h"
+#include "../include/frame_bands.h"
 #include <math.h>
 
+// Columns the composited strip has left of the window, so it serves the next frames while the layers keep
+// the same relative phase (the stars move one column per frame, the phase changes every other frame)
+#define STRIP_MARGIN 2
+
+// Both layers composited once for the window, in the columns of the stars layer
+static SDL_Surface *strip = NULL;
+static int stripStart = 0;    // Column of the stars layer at the left of the strip
+static int stripPhase = -1;   // Offset of the numbers layer from the stars layer in the strip
+
+/**
+ * Returns a column wrapped into a layer of the given width.
+ */
+static int wrapColumn(int column, int width) {
+    column %= width;
+    return column < 0 ? column + width : column;
+}
+
+/**
+ * Draws a layer that repeats horizontally, scrolled by an offset, over an area of a surface. The blits read
+ * only the columns of the layer that land in the area (one or two source rects per row of repeats), instead of
+ * blitting whole copies of the layer and leaving the clipping to SDL.
+ *
+ * Parameters:
+ *   - SDL_Surface *layer: The layer to draw (drawn from its top row at the top of the target).
+ *   - int offset: Position of the left edge of a copy of the layer on the target.
+ *   - SDL_Surface *target: The surface to draw on.
+ *   - SDL_Rect area: The area of the target to cover.
+ */
+static void drawWrappedLayer(SDL_Surface *layer, int offset, SDL_Surface *target, SDL_Rect area) {
+    int x = area.x;
+    int column = wrapColumn(x - offset, layer->w);  // Column of the layer at the left of the area
+
+    while (x < area.x + area.w) {
+        int width = layer->w - column;
+        if (width > area.x + area.w - x) {
+            width = area.x + area.w - x;
+        }
+        SDL_Rect source = {column, area.y, width, area.h};
+        SDL_Rect position = {x, area.y, 0, 0};
+        blitSurface(layer, &source, target, &position);
+        x += width;
+        column = 0;
+    }
+}
+
+/**
+ * Gets the background layers ready to be drawn every frame. The numbers layer is only made of fully opaque
+ * and fully transparent pixels, so it is run-length encoded: its blits skip the transparent runs instead of
+ * blending every pixel. Called after the layers were loaded or converted.
+ *
+ * Parameters:
+ *   - SDL_Surface *numbers: Surface containing the numbers layer of the background.
+ */
+void prepareBackground(SDL_Surface *numbers) {
+    if (numbers && numbers->format->Amask) {
+        SDL_SetAlpha(numbers, SDL_SRCALPHA | SDL_RLEACCEL, SDL_ALPHA_OPAQUE);
+    }
+}
+
 /**
  * Renders a scrolling background on the screen, composed of two layers: stars and numbers.
  * Creates a parallax effect by moving the two layers at different speeds, using `frameTimer`
- * as a reference for their positions. The function draws two instances of each layer to
- * achieve seamless scrolling when the images reset to the starting position.
+ * as a reference for their positions; the layers repeat so the scrolling is seamless.
+ *
+ * Only the window area is composed. The numbers layer is blended over the stars into a strip as wide as the
+ * window (plus STRIP_MARGIN columns) once, and the strip is copied to the window on the following frames
+ * for as long as the two layers keep the same relative phase and the window stays inside it.
  *
  * Parameters:
  *   - SDL_Surface *screen: The main surface where all visuals are rendered.
@@ -14,29 +78,54 @@
  *   - SDL_Surface *numbers: Surface containing the numbers layer of the background.
  */
 void renderBackground(SDL_Surface *screen, SDL_Surface *stars, SDL_Surface *numbers) {
+    if (!stars || !numbers) {
+        return;
+    }
 
-    // Define the position of the first stars layer, moving horizontally based on frameTimer
-    SDL_Rect starPosition = {frameTimer % 2200, 0};
-    SDL_BlitSurface(stars, NULL, screen, &starPosition); // Render the stars layer at calculated position
+    // Positions of the layers, the numbers layer moving faster than the stars layer for parallax effect
+    int starOffset = frameTimer % stars->w;
+    int numberOffset = (int)(frameTimer * 1.5) % numbers->w;
+    int phase = wrapColumn(numberOffset - starOffset, numbers->w);
+    int start = wrapColumn(-starOffset, stars->w);  // Column of the stars layer at the left of the window
+    int height = screen->h < stars->h ? screen->h : stars->h;
 
-    // Define the position of the second stars layer, positioned for seamless looping
-    SDL_Rect starPosition2 = {(frameTimer % 2200) - 2200, 0};
-    SDL_BlitSurface(stars, NULL, screen, &starPosition2); // Render the stars layer offset by its width
+    // Compose the strip again when the phase changed, the window left it, or the window was resized
+    if (!strip || phase != stripPhase || start < stripStart || start > stripStart + STRIP_MARGIN ||
+        strip->w != screen->w + STRIP_MARGIN || strip->h != height ||
+        !isSameFormat(strip->format, screen->format)) {
+        if (!strip || strip->w != screen->w + STRIP_MARGIN || strip->h != height ||
+            !isSameFormat(strip->format, screen->format)) {
+            SDL_FreeSurface(strip);
+            SDL_PixelFormat *format = screen->format;
+            strip = SDL_CreateRGBSurface(SDL_SWSURFACE, screen->w + STRIP_MARGIN, height, format->BitsPerPixel,
+                                         format->Rmask, format->Gmask, format->Bmask, 0);
+        }
+        if (!strip) {
+            // Without the strip, draw the layers straight to the window
+            SDL_Rect window = {0, 0, screen->w, height};
+            drawWrappedLayer(stars, starOffset, screen, window);
+            drawWrappedLayer(numbers, numberOffset, screen, window);
+            return;
+        }
 
-    // Define the position of the first numbers layer, moving faster than the stars layer for parallax effect
-    SDL_Rect numberPosition = {(int)(frameTimer * 1.5) % 2200, 0};
-    SDL_BlitSurface(numbers, NULL, screen, &numberPosition); // Render the numbers layer at calculated position
+        stripStart = start - STRIP_MARGIN;
+        stripPhase = phase;
+        SDL_Rect area = {0, 0, strip->w, strip->h};
+        drawWrappedLayer(stars, -stripStart, strip, area);
+        drawWrappedLayer(numbers, phase - stripStart, strip, area);
+    }
 
-    // Define the position of the second numbers layer, positioned for seamless looping
-    SDL_Rect numberPosition2 = {((int)(frameTimer * 1.5) % 2200) - 2200, 0};
-    SDL_BlitSurface(numbers, NULL, screen, &numberPosition2); // Render the numbers layer offset by its width
+    // Copy the part of the strip under the window (in bands when the frame is recorded)
+    SDL_Rect source = {start - stripStart, 0, screen->w, height};
+    SDL_Rect position = {0, 0, 0, 0};
+    bandBlit(strip, &source, screen, &position);
 }
 
 
 /**
  * Frees the memory associated with the background layers.
  * This function releases the SDL surfaces for the stars and numbers
- * layers to prevent memory leaks when they are no longer needed.
+ * layers, and the strip they were composited into, to prevent memory leaks when they are no longer needed.
  *
  * Parameters:
  *   - SDL_Surface *stars: Surface containing the stars layer of the background.
@@ -49,6 +138,10 @@ void freeBackground(SDL_Surface *stars, SDL_Surface *numbers) {
 
     // Free the surface memory allocated for the stars layer
     SDL_FreeSurface(stars);
+
+    // Free the composited strip
+    SDL_FreeSurface(strip);
+    strip = NULL;
 }
 
 
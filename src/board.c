@@ -0,0 +1,434 @@
+#include "../include/board.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Returns the number of bytes used by the nibble array of adjacent mine counts.
+ */
+static size_t adjacentBytes(const Board *board) {
+    return ((size_t)board->rows * board->cols + 1) / 2;
+}
+
+/**
+ * Allocates a board with the given dimensions and clears every cell.
+ * The three bit-planes and the nibble array share one contiguous block so that
+ * whole-board operations stream through memory instead of chasing row pointers.
+ *
+ * Parameters:
+ *   - Board *board: The board to initialize.
+ *   - int rows: Number of rows in the board.
+ *   - int cols: Number of columns in the board.
+ *
+ * Returns:
+ *   - int: 1 if the board was allocated, 0 if the allocation failed.
+ */
+int initBoard(Board *board, int rows, int cols) {
+    board->work = NULL;
+    board->workCapacity = 0;
+    board->changed = NULL;
+    board->changedCount = 0;
+    board->changedOverflow = 0;
+    board->rows = rows > 0 ? rows : 0;
+    board->cols = cols > 0 ? cols : 0;
+
+    // Round the plane up to whole words (at least one so the block is never empty)
+    size_t cells = (size_t)board->rows * board->cols;
+    board->planeWords = (int)((cells + 31) / 32);
+    if (board->planeWords == 0) {
+        board->planeWords = 1;
+    }
+
+    // One block: mines | revealed | flagged | adjacent nibbles
+    size_t planeBytes = (size_t)board->planeWords * sizeof(uint32_t);
+    uint32_t *block = malloc(3 * planeBytes + adjacentBytes(board) + 1);
+    if (!block) {
+        board->mines = board->revealed = board->flagged = NULL;
+        board->adjacent = NULL;
+        return 0;
+    }
+
+    board->mines = block;
+    board->revealed = block + board->planeWords;
+    board->flagged = block + 2 * board->planeWords;
+    board->adjacent = (uint8_t *)(block + 3 * board->planeWords);
+
+    clearBoard(board);
+    return 1;
+}
+
+/**
+ * Resets every cell to covered, unflagged, mine free, with no adjacent mines.
+ *
+ * Parameters:
+ *   - Board *board: The board to clear.
+ */
+void clearBoard(Board *board) {
+    if (!board->mines) {
+        return;
+    }
+    memset(board->mines, 0, 3 * (size_t)board->planeWords * sizeof(uint32_t) + adjacentBytes(board) + 1);
+    board->changedOverflow = 1;  // Every cell may have changed
+}
+
+/**
+ * Frees the memory block of the board and resets its pointers.
+ *
+ * Parameters:
+ *   - Board *board: The board to free.
+ */
+void freeBoard(Board *board) {
+    free(board->mines); // The other planes live in the same block
+    board->mines = board->revealed = board->flagged = NULL;
+    board->adjacent = NULL;
+
+    free(board->work);
+    board->work = NULL;
+    board->workCapacity = 0;
+
+    free(board->changed);
+    board->changed = NULL;
+    board->changedCount = 0;
+}
+
+/**
+ * Starts logging the cells that get revealed (by floodRevealBoard and the engine) or flagged, so a renderer can
+ * redraw only those cells instead of the whole board. The log holds one entry per cell; when more changes pile
+ * up between two frames, changedOverflow is set and the renderer draws everything. The first frame after this
+ * call always draws everything. Boards that aren't tracked (solver, tools) pay one test per revealed cell.
+ *
+ * Parameters:
+ *   - Board *board: The board to track.
+ *
+ * Returns:
+ *   - int: 1 if the log was allocated, 0 if the allocation failed (changes are then not tracked).
+ */
+int trackBoardChanges(Board *board) {
+    if (!board->changed) {
+        board->changed = malloc(((size_t)board->rows * board->cols + 1) * sizeof(int));
+        if (!board->changed) {
+            printf("Memory allocation failed for the change log\n");
+            return 0;
+        }
+    }
+    board->changedCount = 0;
+    board->changedOverflow = 1;
+    return 1;
+}
+
+/**
+ * Maps an index of the reduced index space (every cell except the excluded ones) to a real cell index.
+ * The excluded indexes must be sorted, each one shifts the cells after it by one.
+ */
+static int skipExcluded(int index, const int *excluded, int excludedCount) {
+    int i;
+    for (i = 0; i < excludedCount; i++) {
+        if (index >= excluded[i]) {
+            index++;
+        }
+    }
+    return index;
+}
+
+/**
+ * Places mines randomly on the board so the first clicked cell (and its neighbours when there is room) is safe.
+ * It uses Floyd's sampling algorithm, a sparse form of the partial Fisher-Yates shuffle that uses the mine
+ * plane itself as the "already picked" set, so it draws exactly one random number per mine at any density.
+ * The same seeded generator and first click always give the same board.
+ *
+ * Parameters:
+ *   - Board *board: The board to place the mines on (expected to be free of mines).
+ *   - int numMines: Number of mines to place, clamped to the number of free cells.
+ *   - int firstClickRow: The row index of the first clicked cell.
+ *   - int firstClickCol: The column index of the first clicked cell.
+ *   - RandomState *rng: The seeded generator used to pick the cells.
+ *
+ * Returns:
+ *   - int: The number of mines placed.
+ */
+int placeBoardMines(Board *board, int numMines, int firstClickRow, int firstClickCol, RandomState *rng) {
+    int cells = board->rows * board->cols;
+    int excluded[9];
+    int excludedCount = 0;
+    int i, j;
+
+    // Keep the whole 3x3 block around the first click free, unless that leaves too few cells for the mines
+    for (i = firstClickRow - 1; i <= firstClickRow + 1; i++) {
+        for (j = firstClickCol - 1; j <= firstClickCol + 1; j++) {
+            if (isInsideBoard(board, i, j)) {
+                excluded[excludedCount++] = cellIndex(board, i, j);
+            }
+        }
+    }
+    if (numMines > cells - excludedCount) {
+        excludedCount = 0;
+        if (isInsideBoard(board, firstClickRow, firstClickCol)) {
+            excluded[excludedCount++] = cellIndex(board, firstClickRow, firstClickCol);
+        }
+    }
+
+    int freeCells = cells - excludedCount;
+    if (numMines > freeCells) {
+        numMines = freeCells;
+    }
+
+    // Floyd's algorithm: for each j in [freeCells - numMines, freeCells) pick t in [0, j], take j if t is taken
+    for (j = freeCells - numMines; j < freeCells; j++) {
+        int t = skipExcluded((int)randomBelow(rng, (uint32_t)j + 1), excluded, excludedCount);
+        if (getBoardBit(board->mines, t)) {
+            t = skipExcluded(j, excluded, excludedCount);
+        }
+        setBoardBit(board->mines, t, 1);
+    }
+
+    return numMines;
+}
+
+/**
+ * Unpacks one row of the mine plane into bytes (0 or 1) with a zero cell of padding on each side.
+ */
+static void unpackMineRow(const Board *board, int row, uint8_t *padded) {
+    int col, index = row * board->cols;
+    padded[0] = 0;
+    padded[board->cols + 1] = 0;
+    for (col = 0; col < board->cols; col++, index++) {
+        padded[col + 1] = (uint8_t)getBoardBit(board->mines, index);
+    }
+}
+
+/**
+ * Horizontal pass of the box-sum: sums[c] = padded[c] + padded[c + 1] + padded[c + 2].
+ */
+static void sumMineRow(const uint8_t *padded, uint8_t *sums, int cols) {
+    int col = 0;
+#ifdef __SSE2__
+    for (; col + 16 <= cols; col += 16) {
+        __m128i left = _mm_loadu_si128((const __m128i *)(padded + col));
+        __m128i middle = _mm_loadu_si128((const __m128i *)(padded + col + 1));
+        __m128i right = _mm_loadu_si128((const __m128i *)(padded + col + 2));
+        _mm_storeu_si128((__m128i *)(sums + col), _mm_add_epi8(_mm_add_epi8(left, middle), right));
+    }
+#endif
+    for (; col < cols; col++) {
+        sums[col] = (uint8_t)(padded[col] + padded[col + 1] + padded[col + 2]);
+    }
+}
+
+/**
+ * Vertical pass of the box-sum: counts[c] = above[c] + current[c] + below[c] minus the cell itself,
+ * forced to 0 on mine cells.
+ */
+static void countMineRow(const uint8_t *above, const uint8_t *current, const uint8_t *below,
+                         const uint8_t *self, uint8_t *counts, int cols) {
+    int col = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    for (; col + 16 <= cols; col += 16) {
+        __m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i *)(above + col)),
+                                   _mm_loadu_si128((const __m128i *)(current + col)));
+        __m128i isMine = _mm_loadu_si128((const __m128i *)(self + col));
+        sum = _mm_sub_epi8(_mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(below + col))), isMine);
+        _mm_storeu_si128((__m128i *)(counts + col), _mm_and_si128(sum, _mm_cmpeq_epi8(isMine, zero)));
+    }
+#endif
+    for (; col < cols; col++) {
+        counts[col] = self[col] ? 0 : (uint8_t)(above[col] + current[col] + below[col] - self[col]);
+    }
+}
+
+/**
+ * Packs a row of byte counts into the nibble array, starting at the row's first cell index.
+ */
+static void packCountRow(Board *board, int row, const uint8_t *counts) {
+    int index = row * board->cols;
+    int col = 0;
+
+    // The row can start in the high nibble of a byte when cols is odd
+    if ((index & 1) && col < board->cols) {
+        board->adjacent[index >> 1] = (uint8_t)((board->adjacent[index >> 1] & 0x0F) | (counts[col] << 4));
+        col++;
+        index++;
+    }
+    for (; col + 1 < board->cols; col += 2, index += 2) {
+        board->adjacent[index >> 1] = (uint8_t)(counts[col] | (counts[col + 1] << 4));
+    }
+    if (col < board->cols) {
+        board->adjacent[index >> 1] = (uint8_t)((board->adjacent[index >> 1] & 0xF0) | counts[col]);
+    }
+}
+
+/**
+ * Calculates the number of adjacent mines of every cell as a separable 3x3 box-sum over the mine plane:
+ * each row is unpacked into bytes and summed horizontally, then three consecutive row sums are added
+ * vertically and the cell's own mine is subtracted. Only three rows are kept at a time, and both passes
+ * are straight byte loops (with an SSE2 path when the compiler targets it) instead of a bounds-checked
+ * neighbour loop per cell. Mine cells keep a count of 0.
+ *
+ * Parameters:
+ *   - Board *board: The board whose mine plane is read and whose adjacent counts are written.
+ */
+void computeAdjacentMines(Board *board) {
+    int cols = board->cols;
+    int row, i;
+    if (board->rows == 0 || cols == 0) {
+        return;
+    }
+
+    // 3 padded mine rows, 3 horizontal sum rows, 1 zero row and 1 output row
+    size_t width = (size_t)cols + 2;
+    uint8_t *scratch = calloc(8 * width, 1);
+    if (!scratch) {
+        printf("Failed to allocate memory for the adjacent mines\n");
+        return;
+    }
+    uint8_t *padded[3], *sums[3];
+    for (i = 0; i < 3; i++) {
+        padded[i] = scratch + i * width;
+        sums[i] = scratch + (3 + i) * width;
+    }
+    uint8_t *zeroRow = scratch + 6 * width;
+    uint8_t *counts = scratch + 7 * width;
+
+    // Prime the window with the first row, the row above the board counts as empty
+    unpackMineRow(board, 0, padded[1]);
+    sumMineRow(padded[1], sums[1], cols);
+
+    for (row = 0; row < board->rows; row++) {
+        uint8_t *above = row > 0 ? sums[0] : zeroRow;
+        uint8_t *below = zeroRow;
+
+        if (row + 1 < board->rows) {
+            unpackMineRow(board, row + 1, padded[2]);
+            sumMineRow(padded[2], sums[2], cols);
+            below = sums[2];
+        }
+
+        countMineRow(above, sums[1], below, padded[1] + 1, counts, cols);
+        packCountRow(board, row, counts);
+
+        // Slide the window down one row
+        uint8_t *oldPadded = padded[0], *oldSums = sums[0];
+        padded[0] = padded[1]; padded[1] = padded[2]; padded[2] = oldPadded;
+        sums[0] = sums[1]; sums[1] = sums[2]; sums[2] = oldSums;
+    }
+
+    free(scratch);
+}
+
+/**
+ * Counts the bits set in a 32-bit word.
+ */
+static int countBits(uint32_t word) {
+#ifdef __GNUC__
+    return __builtin_popcount(word);
+#else
+    int count = 0;
+    while (word) {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * Counts the revealed cells that don't contain a mine by walking the bit-planes a word at a time.
+ *
+ * Parameters:
+ *   - const Board *board: The board to count on.
+ *
+ * Returns:
+ *   - int: The number of revealed safe cells.
+ */
+int countRevealedSafeCells(const Board *board) {
+    int i, count = 0;
+    for (i = 0; i < board->planeWords; i++) {
+        count += countBits(board->revealed[i] & ~board->mines[i]);
+    }
+    return count;
+}
+
+/**
+ * Pushes a cell index on the flood fill work list, growing the list when it is full.
+ * The list is kept in the board so repeated fills don't allocate once it has grown.
+ *
+ * Returns:
+ *   - int: 1 if the index was pushed, 0 if the list could not grow.
+ */
+static int pushWork(Board *board, int *count, int index) {
+    if (*count == board->workCapacity) {
+        int capacity = board->workCapacity ? board->workCapacity * 2 : 2 * (board->rows + board->cols) + 64;
+        int *work = realloc(board->work, capacity * sizeof(int));
+        if (!work) {
+            return 0;
+        }
+        board->work = work;
+        board->workCapacity = capacity;
+    }
+    board->work[(*count)++] = index;
+    return 1;
+}
+
+/**
+ * Reveals the cell at (row, col) and, if it has no adjacent mines, the whole opening around it:
+ * every connected cell without adjacent mines plus the numbered cells on its border.
+ * It uses an explicit work list instead of recursion, so each cell is visited once and a
+ * large opening can't overflow the stack.
+ *
+ * Parameters:
+ *   - Board *board: The board to reveal cells on.
+ *   - int row: The row index of the starting cell.
+ *   - int col: The column index of the starting cell.
+ *
+ * Returns:
+ *   - int: The number of cells that were revealed by this call.
+ */
+int floodRevealBoard(Board *board, int row, int col) {
+    // If the cell is out of bounds or already revealed there is nothing to do
+    if (!isInsideBoard(board, row, col) || isRevealedCell(board, row, col)) {
+        return 0;
+    }
+
+    int start = cellIndex(board, row, col);
+    int revealedCount = 1;
+    int workCount = 0;
+    setBoardBit(board->revealed, start, 1);
+    logBoardChange(board, start);
+
+    // A numbered cell only reveals itself
+    if (getAdjacentMines(board, row, col) != 0 || !pushWork(board, &workCount, start)) {
+        return revealedCount;
+    }
+
+    while (workCount > 0) {
+        int index = board->work[--workCount];
+        int r = index / board->cols;
+        int c = index % board->cols;
+        int i, j;
+
+        // Reveal the 8 neighbours, cells without adjacent mines continue the opening
+        for (i = r - 1; i <= r + 1; i++) {
+            if (i < 0 || i >= board->rows) continue;
+            for (j = c - 1; j <= c + 1; j++) {
+                if (j < 0 || j >= board->cols) continue;
+
+                int neighbor = i * board->cols + j;
+                if (getBoardBit(board->revealed, neighbor)) continue;
+
+                setBoardBit(board->revealed, neighbor, 1);
+                logBoardChange(board, neighbor);
+                revealedCount++;
+
+                if (getAdjacentMines(board, i, j) == 0 && !pushWork(board, &workCount, neighbor)) {
+                    printf("Failed to allocate memory for the flood fill\n");
+                    return revealedCount;
+                }
+            }
+        }
+    }
+
+    return revealedCount;
+}
@@ -1,5 +1,9 @@
 #include "../include/struct.h"
 #include "../include/button_func.h"
+#include "../include/text_cache.h"
+#include "../include/surface_format.h"
+#include "../include/frame_bands.h"
+#include "../include/asset_cache.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
@@ -9,6 +13,8 @@
  * Loads an image from a specified file, resizes it to the given dimensions,
  * and returns the resized image as an SDL_Surface. If the image fails to load,
  * an error message is printed, and the game state is set to GAME_OFF.
+ * The resized image is converted to the pixel format of the window (see convertToDisplayFormat).
+ * The widgets and the game get their images through acquireImage, which calls this once per file and size.
  *
  * Parameters:
  *   - const char *file: Path to the image file to load.
@@ -42,8 +48,8 @@ SDL_Surface* loadAndResizeImage(const char *file, int width, int height) {
     // Free the temporary surface holding the original image
     SDL_FreeSurface(temp);
 
-    // Return the resized image surface
-    return resizedImage;
+    // Convert the image to the pixel format of the window once, so drawing it doesn't convert every pixel
+    return convertToDisplayFormat(resizedImage);
 }
 
 
@@ -52,7 +58,7 @@ SDL_Surface* loadAndResizeImage(const char *file, int width, int height) {
 
 /**
  * Creates a button with specified image, text, dimensions, color, and position.
- * The button's image is loaded and resized, and its position is calculated based on
+ * The button's image comes from the asset cache (loaded and resized the first time), and its position is calculated based on
  * the provided screen percentages.
  *
  * Parameters:
@@ -73,8 +79,9 @@ Button createButton(const char *imageFile, const char *text, SDL_Color textColor
     // Initialize button properties with provided values
     Button button;
 
-    // Load and resize the button's background image
-    button.image = loadAndResizeImage(imageFile, width, height);
+    // Get the button's background image, shared with the other buttons of the same image and size
+    button.image = acquireImage(imageFile, width, height);
+    button.imageFile = imageFile;
 
     // Set button text and color
     button.text = text;
@@ -84,11 +91,15 @@ Button createButton(const char *imageFile, const char *text, SDL_Color textColor
     // Set button state to active
     button.isActive = 1;
 
-    // Set button dimensions
+    // Set button dimensions (fixed, see createScaledButton for buttons that follow the window size)
     button.width = width;
     button.height = height;
+    button.widthPercent = 0;
+    button.heightPercent = 0;
 
-    // Calculate button position based on screen dimensions and percentage offsets
+    // Calculate button position based on screen dimensions and percentage offsets (kept for the relayouts)
+    button.xPercent = xPercent;
+    button.yPercent = yPercent;
     button.position.x = (int)((screenWidth - button.width) * xPercent);
     button.position.y = (int)((screenHeight - button.height) * yPercent);
 
@@ -99,6 +110,58 @@ Button createButton(const char *imageFile, const char *text, SDL_Color textColor
     return button;
 }
 
+/**
+ * Creates a button whose size is a share of the window size (the window frames behind the screens), so a
+ * relayout after a resize gives it the new size.
+ *
+ * Parameters:
+ *   - const char *imageFile: Path to the image file used as the button's background.
+ *   - const char *text: Text displayed on the button.
+ *   - SDL_Color textColor: Color of the text displayed on the button.
+ *   - int textDirection: Direction in which the text is displayed (left, center, or right).
+ *   - float xPercent: X-coordinate percentage position of the button on the screen.
+ *   - float yPercent: Y-coordinate percentage position of the button on the screen.
+ *   - float widthPercent: Share of the window width the button covers.
+ *   - float heightPercent: Share of the window height the button covers.
+ *
+ * Returns:
+ *   - Button: A Button struct instance with initialized properties.
+ */
+Button createScaledButton(const char *imageFile, const char *text, SDL_Color textColor, int textDirection, float xPercent, float yPercent, float widthPercent, float heightPercent) {
+    int width = (int)(screenWidth * widthPercent + 0.5f);
+    int height = (int)(screenHeight * heightPercent + 0.5f);
+
+    Button button = createButton(imageFile, text, textColor, textDirection, xPercent, yPercent, width, height);
+    button.widthPercent = widthPercent;
+    button.heightPercent = heightPercent;
+    return button;
+}
+
+/**
+ * Places a button again for the current window size, from the anchors it was created with. Nothing is loaded
+ * or allocated unless the button follows the window size and its size changed: then its image is resized to
+ * the new size (through the asset cache) and the old one is released.
+ *
+ * Parameters:
+ *   - Button *button: The button to place.
+ */
+void layoutButton(Button *button) {
+    if (button->widthPercent > 0 && button->heightPercent > 0) {
+        int width = (int)(screenWidth * button->widthPercent + 0.5f);
+        int height = (int)(screenHeight * button->heightPercent + 0.5f);
+        if (width != button->width || height != button->height) {
+            SDL_Surface *image = acquireImage(button->imageFile, width, height);
+            releaseImage(button->image);
+            button->image = image;
+            button->width = width;
+            button->height = height;
+        }
+    }
+
+    button->position.x = (int)((screenWidth - button->width) * button->xPercent);
+    button->position.y = (int)((screenHeight - button->height) * button->yPercent);
+}
+
 
 /**
  * Renders a button on the screen, including both its background image and text.
@@ -112,16 +175,21 @@ Button createButton(const char *imageFile, const char *text, SDL_Color textColor
  */
 void renderButton(SDL_Surface *screen, Button *button) {
 
-    // If the button has an image, render it on the screen at the button's position
+    // If the button has an image, render it on the screen at the button's position (the panels scaled to the
+    // window are drawn in bands when the frame is recorded)
     if (button->image) {
-        SDL_BlitSurface(button->image, NULL, screen, &button->position);
+        if (button->widthPercent > 0) {
+            bandBlit(button->image, NULL, screen, &button->position);
+        } else {
+            blitSurface(button->image, NULL, screen, &button->position);
+        }
     }
 
     // If the button has text, render it as well
     if (strcmp(button->text, "") != 0) {
 
-        // Render the button's text to a surface with the specified font and color
-        SDL_Surface *textSurface = TTF_RenderText_Solid(fonts[1], button->text, button->textColor);
+        // Get the button's text rendered with the specified font and color (rendered once, then cached)
+        SDL_Surface *textSurface = getTextSurface(fonts[1], button->text, button->textColor);
 
         // If text rendering fails, output an error and stop rendering
         if (!textSurface) {
@@ -144,26 +212,23 @@ void renderButton(SDL_Surface *screen, Button *button) {
             textPosition.y = button->position.y + (button->height - textSurface->h) / 2;
         }
 
-        // Blit the rendered text to the screen at the calculated position
-        SDL_BlitSurface(textSurface, NULL, screen, &textPosition);
-
-        // Free the text surface after rendering to avoid memory leak
-        SDL_FreeSurface(textSurface);
+        // Blit the rendered text to the screen at the calculated position (the surface belongs to the text cache)
+        blitSurface(textSurface, NULL, screen, &textPosition);
     }
 }
 
 /**
  * Frees the resources associated with a button, specifically the image surface.
- * This function helps prevent memory leaks by deallocating the memory used by
- * the button's background image when it is no longer needed.
+ * The button's reference on its background image is given back to the asset cache,
+ * which frees the image once no other button uses it.
  *
  * Parameters:
  *   - Button *button: The button whose resources are to be freed.
  */
 void freeButton(Button *button) {
 
-    // Free the surface memory allocated for the button's image
-    SDL_FreeSurface(button->image);
+    // Release the button's image
+    releaseImage(button->image);
 
     // Set the image pointer to NULL to avoid dangling pointer references
     button->image = NULL;
@@ -234,9 +299,9 @@ CheckBox createCheckbox(const char *imageFileChecked, const char *imageFileNotCh
     // Initialize checkbox properties with provided values
     CheckBox button;
 
-    // Load and resize the images for the checked and unchecked states of the checkbox
-    button.imageChecked = loadAndResizeImage(imageFileChecked, width, height);
-    button.imageNotChecked = loadAndResizeImage(imageFileNotChecked, width, height);
+    // Get the images for the checked and unchecked states of the checkbox (shared by every checkbox of this size)
+    button.imageChecked = acquireImage(imageFileChecked, width, height);
+    button.imageNotChecked = acquireImage(imageFileNotChecked, width, height);
 
     // Set checkbox text, color, and alignment
     button.text = text;
@@ -250,7 +315,9 @@ CheckBox createCheckbox(const char *imageFileChecked, const char *imageFileNotCh
     button.width = width;
     button.height = height;
 
-    // Calculate the checkbox position based on screen dimensions and percentage offsets
+    // Calculate the checkbox position based on screen dimensions and percentage offsets (kept for the relayouts)
+    button.xPercent = xPercent;
+    button.yPercent = yPercent;
     button.position.x = (int)((screenWidth - button.width) * xPercent);
     button.position.y = (int)((screenHeight - button.height) * yPercent);
 
@@ -261,6 +328,18 @@ CheckBox createCheckbox(const char *imageFileChecked, const char *imageFileNotCh
     return button;
 }
 
+/**
+ * Places a checkbox again for the current window size, from the anchors it was created with
+ * (its size is fixed, so its images are kept).
+ *
+ * Parameters:
+ *   - CheckBox *button: The checkbox to place.
+ */
+void layoutCheckbox(CheckBox *button) {
+    button->position.x = (int)((screenWidth - button->width) * button->xPercent);
+    button->position.y = (int)((screenHeight - button->height) * button->yPercent);
+}
+
 
 /**
  * Renders a checkbox and its associated text on the screen.
@@ -279,18 +358,18 @@ void renderCheckbox(SDL_Surface *screen, CheckBox *button) {
             // Render the appropriate image based on the checkbox's state
             if (button->isChecked == 0) {
                 // Render the checked state if the checkbox is unchecked
-                SDL_BlitSurface(button->imageChecked, NULL, screen, &button->position);
+                blitSurface(button->imageChecked, NULL, screen, &button->position);
             } else {
                 // Render the unchecked state if the checkbox is checked
-                SDL_BlitSurface(button->imageNotChecked, NULL, screen, &button->position);
+                blitSurface(button->imageNotChecked, NULL, screen, &button->position);
             }
         }
     }
 
     // If the checkbox has associated text, render it as well
     if (strcmp(button->text, "") != 0) {
-        // Create a surface for the checkbox's text with the specified font and color
-        SDL_Surface *textSurface = TTF_RenderText_Solid(fonts[2], button->text, button->textColor);
+        // Get the checkbox's text rendered with the specified font and color (rendered once, then cached)
+        SDL_Surface *textSurface = getTextSurface(fonts[2], button->text, button->textColor);
 
         // If text rendering fails, output an error and stop rendering
         if (!textSurface) {
@@ -317,30 +396,27 @@ void renderCheckbox(SDL_Surface *screen, CheckBox *button) {
             textPosition.y = button->position.y + (button->height - textSurface->h) / 2;
         }
 
-        // Blit the text surface to the screen
-        SDL_BlitSurface(textSurface, NULL, screen, &textPosition);
-
-        // Free the text surface to prevent memory leaks
-        SDL_FreeSurface(textSurface);
+        // Blit the text surface to the screen (the surface belongs to the text cache)
+        blitSurface(textSurface, NULL, screen, &textPosition);
     }
 }
 
 
 /**
  * Frees the resources associated with a checkbox, including its images for the checked and unchecked states.
- * The images are unloaded from memory to avoid memory leaks.
+ * The images are released to the asset cache, which frees them once no other checkbox uses them.
  *
  * Parameters:
  *   - CheckBox *button: The checkbox whose resources will be freed.
  */
 void freeCheckbox(CheckBox *button) {
-    // Free the surface for the checked image
-    SDL_FreeSurface(button->imageChecked);
-    button->imageChecked = NULL; // Set the pointer to NULL after freeing
+    // Release the checked image
+    releaseImage(button->imageChecked);
+    button->imageChecked = NULL; // Set the pointer to NULL after releasing
 
-    // Free the surface for the unchecked image
-    SDL_FreeSurface(button->imageNotChecked);
-    button->imageNotChecked = NULL; // Set the pointer to NULL after freeing
+    // Release the unchecked image
+    releaseImage(button->imageNotChecked);
+    button->imageNotChecked = NULL; // Set the pointer to NULL after releasing
 }
 
 
@@ -0,0 +1,165 @@
+#include "../include/digit_atlas.h"
+#include "../include/surface_format.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+/**
+ * Returns the index of a character in the atlas ("0" .. "9" then ":"), or -1 if the atlas doesn't have it.
+ */
+static int glyphIndex(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    return c == ':' ? 10 : -1;
+}
+
+/**
+ * Renders the digits and ':' of a font once, side by side in one 8-bit surface, so numbers can be drawn with
+ * a few blits instead of going through SDL_ttf every frame. The glyphs are rendered with TTF_RenderText_Solid,
+ * whose surfaces use palette entry 0 as the transparent colour key and entry 1 for the text, and the atlas keeps
+ * that layout, so drawDigits can change the text colour by changing one palette entry. The glyphs are drawn from
+ * a copy in the pixel format of the window, made again only when the colour changes.
+ *
+ * Parameters:
+ *   - DigitAtlas *atlas: The atlas to build.
+ *   - TTF_Font *font: The font to render the glyphs with.
+ *
+ * Returns:
+ *   - int: 1 if the atlas was built, 0 if a glyph couldn't be rendered or the surface couldn't be allocated.
+ */
+int buildDigitAtlas(DigitAtlas *atlas, TTF_Font *font) {
+    const char *characters = "0123456789:";
+    SDL_Color white = {255, 255, 255};
+    SDL_Surface *glyphs[DIGIT_ATLAS_GLYPHS];
+    int i, width = 0, height = 0;
+
+    atlas->master = NULL;
+    atlas->surface = NULL;
+    atlas->color = white;
+
+    // Render every glyph on its own to get its size
+    for (i = 0; i < DIGIT_ATLAS_GLYPHS; i++) {
+        char text[2] = {characters[i], '\0'};
+        glyphs[i] = TTF_RenderText_Solid(font, text, white);
+        if (!glyphs[i]) {
+            printf("Unable to render the digit atlas! SDL_ttf Error: %s\n", TTF_GetError());
+            while (i-- > 0) {
+                SDL_FreeSurface(glyphs[i]);
+            }
+            return 0;
+        }
+        atlas->glyphs[i].x = width;
+        atlas->glyphs[i].y = 0;
+        atlas->glyphs[i].w = glyphs[i]->w;
+        atlas->glyphs[i].h = glyphs[i]->h;
+        width += glyphs[i]->w;
+        height = glyphs[i]->h > height ? glyphs[i]->h : height;
+    }
+
+    // Copy them side by side into one surface with the same palette
+    atlas->master = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 8, 0, 0, 0, 0);
+    if (atlas->master) {
+        SDL_SetColors(atlas->master, glyphs[0]->format->palette->colors, 0, glyphs[0]->format->palette->ncolors);
+        SDL_FillRect(atlas->master, NULL, 0);
+        for (i = 0; i < DIGIT_ATLAS_GLYPHS; i++) {
+            SDL_Rect position = atlas->glyphs[i];
+            SDL_BlitSurface(glyphs[i], NULL, atlas->master, &position);
+        }
+        SDL_SetColorKey(atlas->master, SDL_SRCCOLORKEY, 0);
+        convertDigitAtlas(atlas);
+    } else {
+        printf("Memory allocation failed for the digit atlas\n");
+    }
+
+    for (i = 0; i < DIGIT_ATLAS_GLYPHS; i++) {
+        SDL_FreeSurface(glyphs[i]);
+    }
+    return atlas->master != NULL;
+}
+
+/**
+ * Makes the copy of the atlas the glyphs are drawn from, in the pixel format of the window and the current colour,
+ * so the blits don't convert pixels. The 8-bit atlas itself is used when there is no window yet or the copy fails.
+ *
+ * Parameters:
+ *   - DigitAtlas *atlas: The atlas to convert.
+ */
+void convertDigitAtlas(DigitAtlas *atlas) {
+    if (atlas->surface != atlas->master) {
+        SDL_FreeSurface(atlas->surface);
+    }
+    atlas->surface = atlas->master ? displayFormatCopy(atlas->master) : NULL;
+    if (!atlas->surface) {
+        atlas->surface = atlas->master;
+    }
+}
+
+/**
+ * Frees the surfaces of a digit atlas.
+ *
+ * Parameters:
+ *   - DigitAtlas *atlas: The atlas to free.
+ */
+void freeDigitAtlas(DigitAtlas *atlas) {
+    if (atlas->surface != atlas->master) {
+        SDL_FreeSurface(atlas->surface);
+    }
+    SDL_FreeSurface(atlas->master);
+    atlas->surface = NULL;
+    atlas->master = NULL;
+}
+
+/**
+ * Returns the width in pixels of a text drawn with drawDigits (characters the atlas doesn't have take no room).
+ *
+ * Parameters:
+ *   - const DigitAtlas *atlas: The atlas the text will be drawn with.
+ *   - const char *text: The text to measure.
+ *
+ * Returns:
+ *   - int: The width of the text.
+ */
+int measureDigits(const DigitAtlas *atlas, const char *text) {
+    int width = 0;
+    for (; *text; text++) {
+        int index = glyphIndex(*text);
+        if (index >= 0) {
+            width += atlas->glyphs[index].w;
+        }
+    }
+    return width;
+}
+
+/**
+ * Draws a text made of digits and ':' with one blit per character from the atlas. The colour is applied by
+ * changing the text entry of the atlas palette and converting the atlas again, only when it differs from the
+ * last one, so nothing is allocated while the colour stays the same.
+ * Characters the atlas doesn't have are skipped.
+ *
+ * Parameters:
+ *   - SDL_Surface *screen: The surface to draw on.
+ *   - DigitAtlas *atlas: The atlas of the font to draw with.
+ *   - const char *text: The text to draw.
+ *   - int x: The x-coordinate of the left of the text.
+ *   - int y: The y-coordinate of the top of the text.
+ *   - SDL_Color color: The colour of the text.
+ */
+void drawDigits(SDL_Surface *screen, DigitAtlas *atlas, const char *text, int x, int y, SDL_Color color) {
+    if (!atlas->surface) {
+        return;
+    }
+    if (color.r != atlas->color.r || color.g != atlas->color.g || color.b != atlas->color.b) {
+        SDL_SetColors(atlas->master, &color, 1, 1);
+        atlas->color = color;
+        convertDigitAtlas(atlas);
+    }
+
+    for (; *text; text++) {
+        int index = glyphIndex(*text);
+        if (index < 0) continue;
+
+        SDL_Rect position = {x, y, 0, 0};
+        blitSurface(atlas->surface, &atlas->glyphs[index], screen, &position);
+        x += atlas->glyphs[index].w;
+    }
+}
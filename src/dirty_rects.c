@@ -0,0 +1,87 @@
+#include "../include/struct.h"
+#include "../include/dirty_rects.h"
+#include "../include/frame_bands.h"
+#include <SDL.h>
+
+/**
+ * Adds an area that was drawn this frame to the list of areas pushed to the window by presentDirtyRects.
+ * The area is clipped to the window (SDL_UpdateRects must not be given rects outside the screen). An area
+ * on the same row right after the last one (cells revealed along a row) is merged into it, and when the list
+ * is full every area is merged into their bounding box, so any number of changes is pushed with a few rects.
+ *
+ * Parameters:
+ *   - DirtyRects *dirty: The areas of the current frame.
+ *   - SDL_Rect rect: The area that was drawn.
+ */
+void markDirtyRect(DirtyRects *dirty, SDL_Rect rect) {
+    if (dirty->fullRedraw) {
+        return;  // The whole window is flipped anyway
+    }
+
+    // Clip the area to the window
+    int x1 = rect.x < 0 ? 0 : rect.x;
+    int y1 = rect.y < 0 ? 0 : rect.y;
+    int x2 = rect.x + rect.w > screenWidth ? screenWidth : rect.x + rect.w;
+    int y2 = rect.y + rect.h > screenHeight ? screenHeight : rect.y + rect.h;
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    if (dirty->count > 0) {
+        SDL_Rect *last = &dirty->rects[dirty->count - 1];
+
+        // Extend the last area when the new one continues it on the same row
+        if (last->y == y1 && last->h == y2 - y1 && last->x + last->w == x1) {
+            last->w = x2 - last->x;
+            return;
+        }
+
+        // Out of room: replace every area by their bounding box
+        if (dirty->count == MAX_DIRTY_RECTS) {
+            int i;
+            for (i = 0; i < dirty->count; i++) {
+                SDL_Rect *area = &dirty->rects[i];
+                if (area->x < x1) x1 = area->x;
+                if (area->y < y1) y1 = area->y;
+                if (area->x + area->w > x2) x2 = area->x + area->w;
+                if (area->y + area->h > y2) y2 = area->y + area->h;
+            }
+            dirty->count = 0;
+        }
+    }
+
+    SDL_Rect clipped = {x1, y1, x2 - x1, y2 - y1};
+    dirty->rects[dirty->count++] = clipped;
+}
+
+/**
+ * Asks for the whole window to be flipped at the end of the frame (screen changes, resizes, animated screens).
+ *
+ * Parameters:
+ *   - DirtyRects *dirty: The areas of the current frame.
+ */
+void markFullRedraw(DirtyRects *dirty) {
+    dirty->fullRedraw = 1;
+    dirty->count = 0;
+}
+
+/**
+ * Pushes what was drawn this frame to the window: the whole surface with SDL_Flip when a full redraw was asked
+ * for, otherwise only the marked areas with SDL_UpdateRects (nothing at all when nothing changed).
+ * The layers still queued for the frame bands are drawn first, every band is done before the window is pushed.
+ * The list is emptied for the next frame.
+ *
+ * Parameters:
+ *   - DirtyRects *dirty: The areas of the current frame.
+ *   - SDL_Surface *screen: The window surface.
+ */
+void presentDirtyRects(DirtyRects *dirty, SDL_Surface *screen) {
+    endFrameBands();
+    if (dirty->fullRedraw) {
+        SDL_Flip(screen);
+    } else if (dirty->count > 0) {
+        SDL_UpdateRects(screen, dirty->count, dirty->rects);
+    }
+    dirty->count = 0;
+    dirty->fullRedraw = 0;
+}
@@ -0,0 +1,340 @@
+#include "../include/engine.h"
+#include "../include/no_guess.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Difficulty presets used by the mode screen and the headless tools
+const ModePreset modePresets[NUM_MODE_PRESETS] = {
+    {"easy", 9, 9, 10},
+    {"medium", 16, 16, 40},
+    {"hard", 16, 30, 99},
+};
+
+/**
+ * Initializes a field with the given size and mine count. Every cell starts covered, unflagged and
+ * mine free, the mines are only placed on the first reveal so the first clicked cell is always safe.
+ *
+ * Parameters:
+ *   - MineField *field: The field to initialize.
+ *   - int rows: Number of rows in the grid.
+ *   - int cols: Number of columns in the grid.
+ *   - int numMines: Number of mines to place on the first reveal.
+ *   - uint64_t seed: Seed of the random generator used to place the mines.
+ *
+ * Returns:
+ *   - int: 1 if the grid was allocated, 0 if the allocation failed.
+ */
+int initMineField(MineField *field, int rows, int cols, int numMines, uint64_t seed) {
+    field->gameState = 0;  // Indicates the game is still on ( the player did not lose yet )
+    field->firstClick = 0;  // Indicates if the user has clicked for the first time
+    field->rows = rows;  // Number of rows in the grid
+    field->cols = cols;  // Number of columns in the grid
+    field->numMines = numMines;  // Number of mines in the grid
+    field->flagCount = 0;  // Number of flags
+    field->safeCellsLeft = rows * cols - numMines;  // Every safe cell is still covered
+    field->seed = seed;  // Seed used to place the mines on the first click
+    field->pool = NULL;  // Random boards unless the front end asks for no-guess ones
+
+    // Allocate the packed grid, every cell starts with no mine, not revealed, not flagged and no adjacent mines
+    return initBoard(&field->grid, rows, cols);
+}
+
+/**
+ * Frees the memory allocated for the grid of the field.
+ *
+ * Parameters:
+ *   - MineField *field: The field to free.
+ */
+void freeMineField(MineField *field) {
+    freeBoard(&field->grid);
+}
+
+/**
+ * Starts a new game on a field that is already allocated, without reallocating the grid.
+ * This is what the headless tools use to play many games in a row on the same memory.
+ *
+ * Parameters:
+ *   - MineField *field: The field to reset.
+ *   - int numMines: Number of mines to place on the first reveal.
+ *   - uint64_t seed: Seed of the random generator used to place the mines.
+ */
+void restartMineField(MineField *field, int numMines, uint64_t seed) {
+    field->gameState = 0;
+    field->firstClick = 0;
+    field->numMines = numMines;
+    field->flagCount = 0;
+    field->safeCellsLeft = field->rows * field->cols - numMines;
+    field->seed = seed;
+    clearBoard(&field->grid);
+}
+
+/**
+ * Places mines randomly on the grid, ensuring that the first clicked cell (and its neighbours when the board
+ * has room for it) does not contain a mine. The generator is seeded with field->seed, so the same seed and
+ * first click always give the same board, and placement takes one random draw per mine at any density.
+ *
+ * When the field has a no-guess pool, the mines of a pooled board that fits the first click are used instead,
+ * and when none fits a no-guess board is generated on the spot from field->seed on every core. Random placement
+ * is only the fallback when no no-guess board can be found.
+ *
+ * Parameters:
+ *   - MineField *field: The field, which includes the grid and the number of mines to place.
+ *   - int firstClickRow: The row index of the first clicked cell (to avoid placing a mine there).
+ *   - int firstClickCol: The column index of the first clicked cell (to avoid placing a mine there).
+ */
+void placeMines(MineField *field, int firstClickRow, int firstClickCol) {
+    RandomState rng;
+
+    if (field->pool && field->pool->numMines == field->numMines) {
+        if (takePooledBoard(field->pool, &field->grid, firstClickRow, firstClickCol) ||
+            generateNoGuessMines(&field->grid, field->numMines, firstClickRow, firstClickCol, field->seed, 0)) {
+            field->safeCellsLeft = field->rows * field->cols - field->numMines;
+            return;
+        }
+    }
+
+    seedRandom(&rng, field->seed);
+
+    // The number of mines is clamped if the board is too small, keep the win counter in line with it
+    field->numMines = placeBoardMines(&field->grid, field->numMines, firstClickRow, firstClickCol, &rng);
+    field->safeCellsLeft = field->rows * field->cols - field->numMines;
+}
+
+/**
+ * Calculates the number of adjacent mines for each cell in the grid.
+ * The counts are computed by computeAdjacentMines as a box-sum over the mine plane (row sums, then column sums),
+ * which replaces the bounds-checked 3x3 neighbour loop per cell. Mines keep a count of 0.
+ * The result is stored in each cell's adjacent mine nibble.
+ *
+ * Parameters:
+ *   - MineField *field: The field, which includes the grid and each cell's properties (mine status, adjacent mines, etc.).
+ */
+void calculateAdjacentMines(MineField *field) {
+    computeAdjacentMines(&field->grid);
+}
+
+/**
+ * Performs a flood fill on the game grid starting from a specified cell.
+ * The flood fill reveals all connected cells that have no adjacent mines, plus the numbered cells around them.
+ * The work is done iteratively by floodRevealBoard with an explicit work list, so big openings can't overflow the stack.
+ *
+ * This implementation is inspired by the flood fill algorithm described in the following Wikipedia page:
+ * https://en.wikipedia.org/wiki/Flood_fill#:~:text=The%20traditional%20flood-fill%20algorithm,them%20to%20the%20replacement%20color.
+ *
+ * Parameters:
+ *   - MineField *field: The field, which includes the grid of cells.
+ *   - int row: The row index of the starting cell for the flood fill.
+ *   - int col: The column index of the starting cell for the flood fill.
+ *
+ * Returns:
+ *   - int: The number of cells revealed by the flood fill.
+ */
+int floodFill(MineField *field, int row, int col) {
+    return floodRevealBoard(&field->grid, row, col);
+}
+
+/**
+ * Checks if the player has won, which is when every safe cell has been revealed.
+ * The reveal paths keep field->safeCellsLeft up to date, so this doesn't need to scan the grid.
+ *
+ * Parameters:
+ *   - MineField *field: The current field.
+ *
+ * Returns:
+ *   - int: 1 if the player has won, 0 otherwise.
+ */
+int checkWin(MineField *field) {
+    // If a non-mine cell is not revealed, the player hasn't won
+    return field->safeCellsLeft <= 0;
+}
+
+/**
+ * Reveals a cell the way a player click does. On the first reveal the mines are placed around the cell
+ * and the adjacent counts are calculated. Revealing a mine loses the game (gameState = 1), revealing the
+ * last safe cell wins it (gameState = 2). Clicks outside the grid, on flagged or revealed cells, or after
+ * the game is over are ignored.
+ *
+ * Parameters:
+ *   - MineField *field: The current field.
+ *   - int row: The row index of the clicked cell.
+ *   - int col: The column index of the clicked cell.
+ *
+ * Returns:
+ *   - int: The number of cells revealed (0 when the click was ignored or hit a mine).
+ */
+int revealCell(MineField *field, int row, int col) {
+    // Check if click is within grid bounds and the game is still on
+    if (!isInsideBoard(&field->grid, row, col) || field->gameState != 0) {
+        return 0;
+    }
+
+    // First click: Place mines and calculate adjacent mines
+    if (!field->firstClick) {
+        placeMines(field, row, col);
+        calculateAdjacentMines(field);
+        field->firstClick = 1;
+    }
+
+    // Process cell based on its state
+    if (isFlaggedCell(&field->grid, row, col) || isRevealedCell(&field->grid, row, col)) {
+        return 0;  // Ignore clicks on flagged or already revealed cells
+    }
+
+    if (isMineCell(&field->grid, row, col)) {
+        field->gameState = 1;
+        return 0;
+    }
+
+    int revealedCount;
+    if (getAdjacentMines(&field->grid, row, col) == 0) {
+        revealedCount = floodFill(field, row, col);  // Reveal empty region
+    } else {
+        setRevealedCell(&field->grid, row, col, 1);  // Reveal the clicked cell
+        logBoardChange(&field->grid, cellIndex(&field->grid, row, col));
+        revealedCount = 1;
+    }
+    field->safeCellsLeft -= revealedCount;
+
+    if (checkWin(field)) {
+        field->gameState = 2;
+    }
+    return revealedCount;
+}
+
+/**
+ * Calculates the 3BV (Bechtel's Board Benchmark Value) of the field: the number of openings plus the number
+ * of numbered safe cells that no opening reveals, which is the minimum number of left clicks needed to clear
+ * the board. The openings are found with the same flood fill as the game, on a copy of the revealed plane that
+ * is restored afterwards, so the field can be in any state. The mines must already be placed.
+ *
+ * Parameters:
+ *   - MineField *field: The field to measure.
+ *
+ * Returns:
+ *   - int: The 3BV of the board, or -1 if the scratch memory could not be allocated.
+ */
+int calculate3BV(MineField *field) {
+    Board *board = &field->grid;
+    size_t planeBytes = board->planeWords * sizeof(uint32_t);
+    uint32_t *savedRevealed = malloc(planeBytes);
+    if (!savedRevealed) {
+        return -1;
+    }
+    memcpy(savedRevealed, board->revealed, planeBytes);
+    memset(board->revealed, 0, planeBytes);
+
+    int row, col, bbbv = 0;
+
+    // Every opening counts as one click
+    for (row = 0; row < board->rows; row++) {
+        for (col = 0; col < board->cols; col++) {
+            if (!isMineCell(board, row, col) && getAdjacentMines(board, row, col) == 0 && !isRevealedCell(board, row, col)) {
+                floodRevealBoard(board, row, col);
+                bbbv++;
+            }
+        }
+    }
+
+    // Every numbered cell left covered by the openings needs its own click
+    for (row = 0; row < board->rows; row++) {
+        for (col = 0; col < board->cols; col++) {
+            if (!isMineCell(board, row, col) && !isRevealedCell(board, row, col)) {
+                bbbv++;
+            }
+        }
+    }
+
+    memcpy(board->revealed, savedRevealed, planeBytes);
+    free(savedRevealed);
+    return bbbv;
+}
+
+/**
+ * Adds a flag on a covered cell, or removes it if the cell is already flagged, and updates the flag count.
+ *
+ * Parameters:
+ *   - MineField *field: The current field.
+ *   - int row: The row index of the cell.
+ *   - int col: The column index of the cell.
+ *
+ * Returns:
+ *   - int: 1 if the flag was toggled, 0 if the cell is outside the grid or already revealed.
+ */
+int toggleFlag(MineField *field, int row, int col) {
+    // Check if click is within grid bounds and the cell is still covered
+    if (!isInsideBoard(&field->grid, row, col) || isRevealedCell(&field->grid, row, col)) {
+        return 0;
+    }
+
+    int isFlagged = !isFlaggedCell(&field->grid, row, col);
+    setFlaggedCell(&field->grid, row, col, isFlagged);
+    logBoardChange(&field->grid, cellIndex(&field->grid, row, col));
+
+    // Update the count of flagged cells
+    if (isFlagged) {
+        field->flagCount++;
+    } else {
+        field->flagCount--;
+    }
+    return 1;
+}
+
+/**
+ * Writes the grid to an open binary save file as one Cell record per cell, row by row,
+ * so the layout matches the save files written before the grid was packed.
+ *
+ * Parameters:
+ *   - MineField *field: The field to save.
+ *   - FILE *file: The save file, opened for binary writing.
+ */
+void saveMineFieldCells(MineField *field, FILE *file) {
+    int i, j;
+    for (i = 0; i < field->rows; i++) {
+        for (j = 0; j < field->cols; j++) {
+            // Write each Cell data
+            Cell cell;
+            cell.isMine = isMineCell(&field->grid, i, j);
+            cell.isRevealed = isRevealedCell(&field->grid, i, j);
+            cell.isFlagged = isFlaggedCell(&field->grid, i, j);
+            cell.adjacentMines = getAdjacentMines(&field->grid, i, j);
+            fwrite(&cell, sizeof(Cell), 1, file);
+        }
+    }
+}
+
+/**
+ * Reads the Cell records of an open binary save file into a freshly allocated grid.
+ * field->rows, field->cols and field->numMines must already hold the values read from the file header.
+ * The count of covered safe cells isn't stored in the file, it is rebuilt from the loaded grid.
+ *
+ * Parameters:
+ *   - MineField *field: The field to load into (its previous grid is freed).
+ *   - FILE *file: The save file, opened for binary reading and positioned on the first cell record.
+ *
+ * Returns:
+ *   - int: 1 if the grid was loaded, 0 if the allocation failed.
+ */
+int loadMineFieldCells(MineField *field, FILE *file) {
+    // Reallocate the grid with the saved dimensions
+    freeBoard(&field->grid);
+    if (!initBoard(&field->grid, field->rows, field->cols)) {
+        return 0;
+    }
+
+    // Read grid data and pack each Cell record into the board
+    int i, j;
+    for (i = 0; i < field->rows; i++) {
+        for (j = 0; j < field->cols; j++) {
+            Cell cell = {0, 0, 0, 0};
+            fread(&cell, sizeof(Cell), 1, file);
+            setMineCell(&field->grid, i, j, cell.isMine);
+            setRevealedCell(&field->grid, i, j, cell.isRevealed);
+            setFlaggedCell(&field->grid, i, j, cell.isFlagged);
+            setAdjacentMines(&field->grid, i, j, cell.adjacentMines);
+        }
+    }
+
+    // Rebuild the count of covered safe cells (mines may not be placed yet, so count from numMines)
+    field->safeCellsLeft = field->rows * field->cols - field->numMines - countRevealedSafeCells(&field->grid);
+    return 1;
+}
@@ -0,0 +1,492 @@
+#include "../include/frame_bands.h"
+#include "../include/surface_format.h"
+#include "../include/thread_pool.h"
+#include <SDL.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Commands allocated the first time the queue grows (doubled afterwards)
+#define BAND_COMMANDS_INITIAL_CAPACITY 16
+
+typedef enum {
+    BAND_BLIT,    // A surface blitted on the window
+    BAND_GRID     // The grid drawn with compositeGrid
+} BandCommandType;
+
+// One queued layer
+typedef struct {
+    BandCommandType type;
+    SDL_Surface *source;
+    SDL_Rect sourceRect;
+    int wholeSource;            // 1 when the blit had no source rect
+    SDL_Rect destinationRect;
+    TileAtlas *atlas;
+    const Board *board;
+    int originX;
+    int originY;
+    SDL_Rect clip;
+} BandCommand;
+
+// What one worker draws with: its band of the window and its own views of the window and of the sources
+typedef struct {
+    SDL_Rect band;
+    SDL_Surface *target;        // View of the window, clipped to the band
+    SDL_Surface **sources;      // View of the source of each command (NULL for the grid commands)
+    int sourceCapacity;
+    int *rowTiles;              // Row buffer of compositeGrid for this worker
+    int rowCapacity;
+} BandWorker;
+
+static struct {
+    int workers;                // Bands of a frame, the calling thread draws band 0
+    BandWorker *bands;
+    pthread_t *threads;
+    pthread_mutex_t lock;
+    pthread_cond_t start;       // Signalled when a flush hands out the bands
+    pthread_cond_t done;        // Signalled when the last band is drawn
+    unsigned generation;        // Number of flushes handed out
+    int pending;                // Bands of the current flush still being drawn by the other threads
+    int stopping;
+
+    SDL_Surface *window;        // Window surface of the recorded frame, NULL when no frame is recorded
+    BandCommand *commands;
+    int commandCount;
+    int commandCapacity;
+} frameBands = {1};
+
+/**
+ * Returns the overlap of two rects (w and h are 0 when they don't overlap).
+ */
+static SDL_Rect intersectRects(SDL_Rect a, SDL_Rect b) {
+    int x1 = a.x > b.x ? a.x : b.x;
+    int y1 = a.y > b.y ? a.y : b.y;
+    int x2 = a.x + a.w < b.x + b.w ? a.x + a.w : b.x + b.w;
+    int y2 = a.y + a.h < b.y + b.h ? a.y + a.h : b.y + b.h;
+    SDL_Rect overlap = {x1, y1, 0, 0};
+    if (x1 < x2 && y1 < y2) {
+        overlap.w = x2 - x1;
+        overlap.h = y2 - y1;
+    }
+    return overlap;
+}
+
+/**
+ * Makes a surface that shares the pixels of another one, with the same format, colour key and alpha settings,
+ * so a worker can blit from or to it without touching the blit map and clip rect of the original.
+ */
+static SDL_Surface* createView(SDL_Surface *surface) {
+    SDL_PixelFormat *format = surface->format;
+    SDL_Surface *view = SDL_CreateRGBSurfaceFrom(surface->pixels, surface->w, surface->h, format->BitsPerPixel,
+                                                 surface->pitch, format->Rmask, format->Gmask, format->Bmask,
+                                                 format->Amask);
+    if (!view) {
+        return NULL;
+    }
+    if (format->palette && view->format->palette) {
+        SDL_SetColors(view, format->palette->colors, 0, format->palette->ncolors);
+    }
+    if (surface->flags & SDL_SRCCOLORKEY) {
+        SDL_SetColorKey(view, SDL_SRCCOLORKEY, format->colorkey);
+    }
+    SDL_SetAlpha(view, surface->flags & SDL_SRCALPHA, format->alpha);
+    return view;
+}
+
+/**
+ * Draws every queued layer clipped to one band. Runs on the worker threads, with only the views of its band.
+ */
+static void drawBand(BandWorker *band) {
+    int i;
+    for (i = 0; i < frameBands.commandCount; i++) {
+        BandCommand *command = &frameBands.commands[i];
+        if (command->type == BAND_BLIT) {
+            SDL_Rect sourceRect = command->sourceRect;
+            SDL_Rect destinationRect = command->destinationRect;  // SDL clips its own copy
+            SDL_BlitSurface(band->sources[i], command->wholeSource ? NULL : &sourceRect, band->target, &destinationRect);
+        } else {
+            SDL_Rect clip = intersectRects(command->clip, band->band);
+            if (clip.w == 0) continue;
+
+            // The atlas is shared read-only, the row buffer is the worker's own
+            TileAtlas atlas = *command->atlas;
+            atlas.rowTiles = band->rowTiles;
+            atlas.rowCapacity = band->rowCapacity;
+            SDL_SetClipRect(band->target, &clip);
+            compositeGrid(band->target, &atlas, command->board, command->originX, command->originY);
+            SDL_SetClipRect(band->target, &band->band);
+            band->rowTiles = atlas.rowTiles;
+            band->rowCapacity = atlas.rowCapacity;
+        }
+    }
+}
+
+/**
+ * Thread function of the workers 1 .. workers - 1: draws its band of every flush until the bands are freed.
+ */
+static void *runBandWorker(void *argument) {
+    BandWorker *band = &frameBands.bands[(intptr_t)argument];
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&frameBands.lock);
+    for (;;) {
+        while (frameBands.generation == seen && !frameBands.stopping) {
+            pthread_cond_wait(&frameBands.start, &frameBands.lock);
+        }
+        if (frameBands.stopping) {
+            break;
+        }
+        seen = frameBands.generation;
+        pthread_mutex_unlock(&frameBands.lock);
+
+        drawBand(band);
+
+        pthread_mutex_lock(&frameBands.lock);
+        if (--frameBands.pending == 0) {
+            pthread_cond_signal(&frameBands.done);
+        }
+    }
+    pthread_mutex_unlock(&frameBands.lock);
+    return NULL;
+}
+
+/**
+ * Starts the threads that draw the bands of the frames. Threads that can't be started leave fewer bands.
+ *
+ * Parameters:
+ *   - int workers: Number of bands, one per thread including the calling one (0 or less uses every core,
+ *                  1 draws everything on the calling thread, as before).
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if the memory couldn't be allocated (frames are then drawn on the calling thread).
+ */
+int initFrameBands(int workers) {
+    if (workers <= 0) {
+        workers = getCoreCount();
+    }
+    frameBands.workers = 1;
+    if (workers == 1) {
+        return 1;
+    }
+
+    frameBands.bands = calloc(workers, sizeof(BandWorker));
+    frameBands.threads = malloc(workers * sizeof(pthread_t));
+    if (!frameBands.bands || !frameBands.threads) {
+        printf("Failed to allocate memory for the frame bands\n");
+        free(frameBands.bands);
+        free(frameBands.threads);
+        frameBands.bands = NULL;
+        frameBands.threads = NULL;
+        return 0;
+    }
+
+    pthread_mutex_init(&frameBands.lock, NULL);
+    pthread_cond_init(&frameBands.start, NULL);
+    pthread_cond_init(&frameBands.done, NULL);
+    frameBands.stopping = 0;
+    frameBands.generation = 0;
+
+    int i;
+    for (i = 1; i < workers; i++) {
+        if (pthread_create(&frameBands.threads[i], NULL, runBandWorker, (void *)(intptr_t)i) != 0) {
+            break;  // Draw with the threads that did start
+        }
+    }
+    frameBands.workers = i;
+    return 1;
+}
+
+/**
+ * Returns the number of bands a frame is cut into.
+ */
+int getFrameBandCount(void) {
+    return frameBands.workers;
+}
+
+/**
+ * Starts recording the full-window layers drawn on a window surface (see bandBlit and queueBandGrid). Nothing
+ * is recorded with a single band, or when the window has to be locked to reach its pixels.
+ *
+ * Parameters:
+ *   - SDL_Surface *window: The window surface the frame is drawn on.
+ */
+void beginFrameBands(SDL_Surface *window) {
+    endFrameBands();
+    if (frameBands.workers > 1 && window && window->pixels && !SDL_MUSTLOCK(window)) {
+        frameBands.window = window;
+    }
+}
+
+/**
+ * Appends a command to the queue.
+ *
+ * Returns:
+ *   - BandCommand*: The new command, or NULL if the queue couldn't grow.
+ */
+static BandCommand* addBandCommand(void) {
+    if (frameBands.commandCount == frameBands.commandCapacity) {
+        int capacity = frameBands.commandCapacity ? frameBands.commandCapacity * 2 : BAND_COMMANDS_INITIAL_CAPACITY;
+        BandCommand *commands = realloc(frameBands.commands, capacity * sizeof(BandCommand));
+        if (!commands) {
+            printf("Memory allocation failed for the frame bands\n");
+            return NULL;
+        }
+        frameBands.commands = commands;
+        frameBands.commandCapacity = capacity;
+    }
+    return &frameBands.commands[frameBands.commandCount++];
+}
+
+/**
+ * Draws a surface on the window like blitSurface. While a frame of that window is recorded the blit is queued
+ * and drawn by the bands; otherwise (other destinations, run-length encoded or locked sources) it is done right
+ * away. Unlike SDL_BlitSurface, the destination rect isn't changed.
+ *
+ * Parameters:
+ *   - SDL_Surface *source: The surface to copy from (must not change before the queue is drawn).
+ *   - SDL_Rect *sourceRect: The area to copy (NULL for the whole surface).
+ *   - SDL_Surface *destination: The surface to copy to.
+ *   - SDL_Rect *destinationRect: The position to copy to (NULL for the top left corner).
+ */
+void bandBlit(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *destination, SDL_Rect *destinationRect) {
+    if (!frameBands.window || destination != frameBands.window || !source || !source->pixels ||
+        SDL_MUSTLOCK(source) || (source->flags & SDL_RLEACCEL)) {
+        SDL_Rect position = {0, 0, 0, 0};
+        blitSurface(source, sourceRect, destination, destinationRect ? destinationRect : &position);
+        return;
+    }
+
+    BandCommand *command = addBandCommand();
+    if (!command) {
+        SDL_Rect position = {0, 0, 0, 0};
+        blitSurface(source, sourceRect, destination, destinationRect ? destinationRect : &position);
+        return;
+    }
+    command->type = BAND_BLIT;
+    command->source = source;
+    command->wholeSource = sourceRect == NULL;
+    if (sourceRect) {
+        command->sourceRect = *sourceRect;
+    }
+    command->destinationRect.x = destinationRect ? destinationRect->x : 0;
+    command->destinationRect.y = destinationRect ? destinationRect->y : 0;
+    command->destinationRect.w = command->destinationRect.h = 0;
+    countBlit(source, destination);
+}
+
+/**
+ * Queues the grid drawn by compositeGrid, when a frame of the destination is recorded and the atlas is in its
+ * pixel format (otherwise the caller draws it).
+ *
+ * Parameters:
+ *   - SDL_Surface *destination: The surface the grid is drawn on.
+ *   - TileAtlas *atlas: The atlas (must not change before the queue is drawn).
+ *   - const Board *board: The board to draw (must not change before the queue is drawn).
+ *   - int originX: The x-coordinate of the top left corner of the grid.
+ *   - int originY: The y-coordinate of the top left corner of the grid.
+ *   - SDL_Rect clip: The area the grid is clipped to.
+ *
+ * Returns:
+ *   - int: 1 if the grid was queued, 0 if the caller has to draw it.
+ */
+int queueBandGrid(SDL_Surface *destination, TileAtlas *atlas, const Board *board, int originX, int originY, SDL_Rect clip) {
+    if (!frameBands.window || destination != frameBands.window || !atlas->surface ||
+        !isSameFormat(destination->format, atlas->surface->format)) {
+        return 0;
+    }
+
+    BandCommand *command = addBandCommand();
+    if (!command) {
+        return 0;
+    }
+    command->type = BAND_GRID;
+    command->atlas = atlas;
+    command->board = board;
+    command->originX = originX;
+    command->originY = originY;
+    command->clip = clip;
+    return 1;
+}
+
+/**
+ * Draws the queued layers before a blit that reads or writes the recorded window, so the layers stay in the
+ * order they were drawn in. Called by blitSurface.
+ *
+ * Parameters:
+ *   - SDL_Surface *source: The source of the blit about to be done.
+ *   - SDL_Surface *destination: Its destination.
+ */
+void flushBandsBefore(SDL_Surface *source, SDL_Surface *destination) {
+    if (frameBands.commandCount > 0 && (source == frameBands.window || destination == frameBands.window)) {
+        flushFrameBands();
+    }
+}
+
+/**
+ * Frees the views made for a flush.
+ */
+static void freeBandViews(int commandCount) {
+    int i, j;
+    for (i = 0; i < frameBands.workers; i++) {
+        BandWorker *band = &frameBands.bands[i];
+        if (band->target) {
+            SDL_FreeSurface(band->target);
+            band->target = NULL;
+        }
+        for (j = 0; j < commandCount && j < band->sourceCapacity; j++) {
+            if (band->sources[j]) {
+                SDL_FreeSurface(band->sources[j]);
+                band->sources[j] = NULL;
+            }
+        }
+    }
+}
+
+/**
+ * Makes the views of one band for the queued commands.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if a view or the memory couldn't be made.
+ */
+static int createBandViews(BandWorker *band) {
+    int i;
+    if (band->sourceCapacity < frameBands.commandCount) {
+        SDL_Surface **sources = realloc(band->sources, frameBands.commandCapacity * sizeof(SDL_Surface*));
+        if (!sources) {
+            printf("Memory allocation failed for the frame bands\n");
+            return 0;
+        }
+        for (i = band->sourceCapacity; i < frameBands.commandCapacity; i++) {
+            sources[i] = NULL;
+        }
+        band->sources = sources;
+        band->sourceCapacity = frameBands.commandCapacity;
+    }
+
+    band->target = createView(frameBands.window);
+    if (!band->target) {
+        return 0;
+    }
+    SDL_SetClipRect(band->target, &band->band);
+
+    for (i = 0; i < frameBands.commandCount; i++) {
+        if (frameBands.commands[i].type == BAND_BLIT) {
+            band->sources[i] = createView(frameBands.commands[i].source);
+            if (!band->sources[i]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * Draws the queued layers on the calling thread, when the views couldn't be made.
+ */
+static void drawQueueDirectly(void) {
+    int i;
+    SDL_Surface *window = frameBands.window;
+    for (i = 0; i < frameBands.commandCount; i++) {
+        BandCommand *command = &frameBands.commands[i];
+        if (command->type == BAND_BLIT) {
+            SDL_Rect sourceRect = command->sourceRect;
+            SDL_Rect destinationRect = command->destinationRect;
+            SDL_BlitSurface(command->source, command->wholeSource ? NULL : &sourceRect, window, &destinationRect);
+        } else {
+            SDL_SetClipRect(window, &command->clip);
+            compositeGrid(window, command->atlas, command->board, command->originX, command->originY);
+            SDL_SetClipRect(window, NULL);
+        }
+    }
+}
+
+/**
+ * Draws the queued layers: the window is cut into one horizontal band per worker, the views of every band
+ * are made here, then every worker draws all the layers clipped to its band (this thread draws band 0) and the
+ * function waits until the last band is done. The queue is emptied, the frame stays recorded.
+ */
+void flushFrameBands(void) {
+    if (!frameBands.window || frameBands.commandCount == 0) {
+        return;
+    }
+
+    SDL_Surface *window = frameBands.window;
+    int commandCount = frameBands.commandCount;
+    int i, ready = 1;
+    for (i = 0; i < frameBands.workers; i++) {
+        BandWorker *band = &frameBands.bands[i];
+        band->band.x = 0;
+        band->band.y = window->h * i / frameBands.workers;
+        band->band.w = window->w;
+        band->band.h = window->h * (i + 1) / frameBands.workers - band->band.y;
+        if (ready && !createBandViews(band)) {
+            ready = 0;
+        }
+    }
+
+    if (!ready) {
+        drawQueueDirectly();
+    } else {
+        // Hand the bands out and wait for them (the barrier before the frame is shown)
+        pthread_mutex_lock(&frameBands.lock);
+        frameBands.pending = frameBands.workers - 1;
+        frameBands.generation++;
+        pthread_cond_broadcast(&frameBands.start);
+        pthread_mutex_unlock(&frameBands.lock);
+
+        drawBand(&frameBands.bands[0]);
+
+        pthread_mutex_lock(&frameBands.lock);
+        while (frameBands.pending > 0) {
+            pthread_cond_wait(&frameBands.done, &frameBands.lock);
+        }
+        pthread_mutex_unlock(&frameBands.lock);
+    }
+
+    freeBandViews(commandCount);
+    frameBands.commandCount = 0;
+}
+
+/**
+ * Draws what is left in the queue and stops recording. Called before the frame is pushed to the screen.
+ */
+void endFrameBands(void) {
+    flushFrameBands();
+    frameBands.window = NULL;
+}
+
+/**
+ * Stops the worker threads and frees the bands (at exit).
+ */
+void freeFrameBands(void) {
+    int i;
+    endFrameBands();
+    if (frameBands.workers > 1) {
+        pthread_mutex_lock(&frameBands.lock);
+        frameBands.stopping = 1;
+        pthread_cond_broadcast(&frameBands.start);
+        pthread_mutex_unlock(&frameBands.lock);
+        for (i = 1; i < frameBands.workers; i++) {
+            pthread_join(frameBands.threads[i], NULL);
+        }
+        pthread_mutex_destroy(&frameBands.lock);
+        pthread_cond_destroy(&frameBands.start);
+        pthread_cond_destroy(&frameBands.done);
+    }
+
+    if (frameBands.bands) {
+        for (i = 0; i < frameBands.workers; i++) {
+            free(frameBands.bands[i].sources);
+            free(frameBands.bands[i].rowTiles);
+        }
+    }
+    free(frameBands.bands);
+    free(frameBands.threads);
+    free(frameBands.commands);
+    frameBands.bands = NULL;
+    frameBands.threads = NULL;
+    frameBands.commands = NULL;
+    frameBands.commandCount = frameBands.commandCapacity = 0;
+    frameBands.workers = 1;
+}
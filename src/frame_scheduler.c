@@ -0,0 +1,120 @@
+#include "../include/frame_scheduler.h"
+#include <SDL.h>
+
+// The last milliseconds before a deadline are waited without sleeping, SDL_Delay can oversleep by that much
+#define SPIN_MARGIN_MS 2
+
+/**
+ * Sets up the scheduler of the main loop. The window starts visible and focused.
+ *
+ * Parameters:
+ *   - FrameScheduler *scheduler: The scheduler to set up.
+ *   - int targetFps: Frames per second while something animates (0 or less for no cap).
+ */
+void initFrameScheduler(FrameScheduler *scheduler, int targetFps) {
+    scheduler->targetFps = targetFps > 0 ? targetFps : 0;
+    scheduler->nextFrame = SDL_GetTicks();
+    scheduler->animating = 0;
+    scheduler->windowVisible = 1;
+    scheduler->windowFocused = 1;
+}
+
+/**
+ * Keeps track of the window state from the SDL_ACTIVEEVENT events: iconified windows don't need frames at all,
+ * and nothing animates while the window doesn't have the input focus.
+ *
+ * Parameters:
+ *   - FrameScheduler *scheduler: The scheduler of the main loop.
+ *   - SDL_Event *event: The event to look at (other events are ignored).
+ *
+ * Returns:
+ *   - int: 1 if the window was just restored or focused (its content must be redrawn), 0 otherwise.
+ */
+int handleSchedulerEvent(FrameScheduler *scheduler, SDL_Event *event) {
+    if (event->type != SDL_ACTIVEEVENT) {
+        return 0;
+    }
+
+    int restored = 0;
+    if (event->active.state & SDL_APPACTIVE) {
+        restored |= event->active.gain && !scheduler->windowVisible;
+        scheduler->windowVisible = event->active.gain;
+    }
+    if (event->active.state & SDL_APPINPUTFOCUS) {
+        restored |= event->active.gain && !scheduler->windowFocused;
+        scheduler->windowFocused = event->active.gain;
+    }
+    return restored;
+}
+
+/**
+ * Waits until an event is queued or the time is reached, without taking the event out of the queue.
+ * SDL 1.2 has no SDL_WaitEvent with a timeout (and its SDL_WaitEvent polls every 10 ms itself), so this
+ * pumps and peeks the queue the same way and sleeps in between.
+ *
+ * Returns:
+ *   - int: 1 if an event is waiting, 0 if the time was reached.
+ */
+static int waitForEvent(Uint32 timeoutMs) {
+    Uint32 start = SDL_GetTicks();
+    SDL_Event event;
+
+    while (1) {
+        SDL_PumpEvents();
+        if (SDL_PeepEvents(&event, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0) {
+            return 1;
+        }
+        Uint32 elapsed = SDL_GetTicks() - start;
+        if (elapsed >= timeoutMs) {
+            return 0;
+        }
+        SDL_Delay(timeoutMs - elapsed < 10 ? timeoutMs - elapsed : 10);
+    }
+}
+
+/**
+ * Waits for the next frame of the main loop. A screen that animates (and a visible, focused window) gets frames
+ * at the target rate: the loop sleeps until the frame deadline, then waits the last SPIN_MARGIN_MS without
+ * sleeping, and the deadlines advance by whole frame periods so the rate doesn't drift. Otherwise nothing
+ * changes on screen by itself, so the loop sleeps until an event arrives or the wakeup time (a timer to redraw)
+ * has passed. An iconified window only wakes up for events (and every IDLE_WAIT_MS).
+ *
+ * Parameters:
+ *   - FrameScheduler *scheduler: The scheduler of the main loop.
+ *   - int screenAnimates: 1 if the current screen changes every frame (scrolling background).
+ *   - Uint32 wakeupMs: Milliseconds until the screen must be redrawn even without events (capped to IDLE_WAIT_MS).
+ */
+void waitForNextFrame(FrameScheduler *scheduler, int screenAnimates, Uint32 wakeupMs) {
+    int animating = screenAnimates && scheduler->windowVisible && scheduler->windowFocused;
+
+    if (!animating) {
+        if (!scheduler->windowVisible || wakeupMs > IDLE_WAIT_MS) {
+            wakeupMs = IDLE_WAIT_MS;
+        }
+        waitForEvent(wakeupMs);
+        scheduler->animating = 0;
+        return;
+    }
+
+    if (scheduler->targetFps == 0) {
+        scheduler->animating = 1;
+        return;  // No cap, the loop runs as fast as it can
+    }
+
+    double period = 1000.0 / scheduler->targetFps;
+    double now = SDL_GetTicks();
+
+    // Start a new run of deadlines when the animation starts again or the loop fell more than a frame behind
+    if (!scheduler->animating || now > scheduler->nextFrame + period) {
+        scheduler->nextFrame = now;
+    }
+    scheduler->animating = 1;
+
+    // Sleep until the deadline is close, then wait out the rest
+    while (now < scheduler->nextFrame) {
+        double left = scheduler->nextFrame - now;
+        SDL_Delay(left > SPIN_MARGIN_MS ? (Uint32)(left - SPIN_MARGIN_MS) : 0);
+        now = SDL_GetTicks();
+    }
+    scheduler->nextFrame += period;
+}
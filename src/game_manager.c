@@ -1,15 +1,118 @@
 #include "../include/game_manager.h"
 #include "../include/struct.h"
 #include "../include/button_func.h"
+#include "../include/dirty_rects.h"
+#include "../include/digit_atlas.h"
+#include "../include/frame_bands.h"
+#include "../include/surface_format.h"
+#include "../include/tile_levels.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 #include <stdlib.h>
-#include <time.h>
 #include <string.h>
 
+// Margin left under the grid, and height of the bar at the top of the game screen (pause button and timer)
+// that a grid larger than the window is kept out of
+#define GRID_BOTTOM_MARGIN 50
+#define GRID_TOP_BAR 100
+
+// Copy of the window under the timer, taken on the full redraws so the timer can be redrawn on its own
+static SDL_Surface *timerBackdrop = NULL;
+
+// Image of each tile of the atlas, in the tile order of tile_atlas.h
+static const char *assetFiles[TILE_COUNT] = {
+    "assets/images/1.jpg", "assets/images/2.jpg", "assets/images/3.jpg", "assets/images/4.jpg",
+    "assets/images/5.jpg", "assets/images/6.jpg", "assets/images/7.jpg", "assets/images/8.jpg",
+    "assets/images/covered.jpg", "assets/images/empty.jpg", "assets/images/bomb.jpg", "assets/images/flag.jpg"
+};
+
+// Cell images decoded once and pre-scaled to power-of-two sizes, the atlas is built from them at any cell size
+static TileLevels cellLevels;
+
+/**
+ * Builds the tile atlas of the game from the 12 cell images at the cell size of the view. The images are decoded
+ * the first time only, into the pre-scaled levels of cellLevels, and every atlas is made from those levels.
+ * A new game at the same cell size, with the window in the same pixel format, keeps the atlas it has.
+ *
+ * Parameters:
+ *   - Game *game: The game whose tile atlas is built.
+ */
+static void loadGameAssets(Game *game) {
+    int size = game->view.cellSize;
+    SDL_Surface *window = SDL_GetVideoSurface();
+    if (game->tiles.surface && game->tiles.size == size &&
+        (!window || isSameFormat(window->format, game->tiles.surface->format))) {
+        return;
+    }
+
+    SDL_Surface *images[TILE_COUNT];
+    int i;
+    for (i = 0; i < TILE_COUNT; i++) {
+        if (!hasTileLevels(&cellLevels, i)) {
+            SDL_Surface *image = IMG_Load(assetFiles[i]);
+            if (!image) {
+                printf("Failed to load image: %s\n", IMG_GetError());
+            } else {
+                setTileImage(&cellLevels, i, image);
+                SDL_FreeSurface(image);
+            }
+        }
+        images[i] = scaleTile(&cellLevels, i, size);
+    }
+    if (!buildTileAtlas(&game->tiles, images, size, window)) {
+        printf("Failed to build the tile atlas\n");
+    }
+    for (i = 0; i < TILE_COUNT; i++) {
+        if (images[i]) {
+            SDL_FreeSurface(images[i]);
+        }
+    }
+}
+
 /**
- * Initializes the game by setting up the grid, loading the necessary images, and allocating memory for the assets.
+ * Returns the part of the window the grid is drawn in at a cell size: everything above the bottom margin when the
+ * whole grid fits there (it is centred at the bottom, where the game always drew it), and only the part under the
+ * top bar when it doesn't, so the scrolled grid never covers the pause button and the timer.
+ */
+static SDL_Rect gridViewArea(Game *game, int size) {
+    // The height is worked out in an int, the Uint16 of the rect would wrap on a window shorter than the margins
+    int height = screenHeight - GRID_BOTTOM_MARGIN;
+    SDL_Rect area = {0, 0, screenWidth, 0};
+    if (game->field.cols * size > screenWidth || game->field.rows * size > height) {
+        area.y = GRID_TOP_BAR;
+        height -= GRID_TOP_BAR;
+    }
+    area.h = height > 0 ? height : 0;
+    return area;
+}
+
+/**
+ * Points the view at the grid of a new or loaded game, at the cell size of the game. A grid that doesn't fit in
+ * the window is zoomed out until it does, down to MIN_VIEW_CELL_SIZE, and can be panned past that.
+ * The tile atlas is built for the resulting cell size.
+ *
+ * Parameters:
+ *   - Game *game: The game whose view is set up.
+ */
+static void fitGameView(Game *game) {
+    int size = game->cellSize;
+    SDL_Rect area = gridViewArea(game, size);
+    if (area.y > 0 && game->field.rows > 0 && game->field.cols > 0) {
+        int fitWidth = area.w / game->field.cols, fitHeight = area.h / game->field.rows;
+        size = fitWidth < fitHeight ? fitWidth : fitHeight;
+        size = size < game->cellSize ? size : game->cellSize;
+    }
+    if (size < MIN_VIEW_CELL_SIZE) size = MIN_VIEW_CELL_SIZE;
+    if (size > MAX_VIEW_CELL_SIZE) size = MAX_VIEW_CELL_SIZE;
+
+    initViewport(&game->view, gridViewArea(game, size), game->field.rows, game->field.cols, size);
+    loadGameAssets(game);
+}
+
+/**
+ * Initializes the game by setting up the grid and building the tile atlas of the cell images. It is called for
+ * every new game: the grid of the previous game is reused when the size is the same and freed otherwise.
  * The function also sets the initial values for the game's properties, such as rows, columns, number of mines, and cell size.
  * It then populates the grid with default cell values and loads the images for the game elements like numbers, bombs, and flags.
  *
@@ -18,64 +121,33 @@
  */
 void initializeGame(Game *game) {
     // Initialize basic game properties
-    game->gameState = 0;  // Indicates the game is still on ( the player did not lose yet )
-    game->firstClick = 0;  // Indicates if the user has clicked for the first time
-    game->rows = gameRowsNum;  // Number of rows in the grid
-    game->cols = gameColsNum;  // Number of columns in the grid
-    game->numMines = gameMinesNum;  // Number of mines in the grid
-    game->flagCount = 0;  // Number of flags
     game->cellSize = cellSize;  // Size of each cell in the grid
     game->startTime = SDL_GetTicks();
     game->elapsedTime = (SDL_GetTicks() - game->startTime) / 1000 ; // elapsed time in seconds
     game->pausedTime = 0;
 
-    // Allocate memory for 12 images representing game assets (numbers, bomb, flag, etc.)
-    game->assets = malloc(12 * sizeof(SDL_Surface*));
-    if (!game->assets) {
-        printf("Memory allocation failed for imageNumbers\n");
-        return;  // If memory allocation fails, terminate the function
-    }
-
-    // Load images into the asset array (each index corresponds to a specific game asset)
-    game->assets[0] = loadAndResizeImage("assets/images/1.jpg", game->cellSize, game->cellSize);
-    game->assets[1] = loadAndResizeImage("assets/images/2.jpg", game->cellSize, game->cellSize);
-    game->assets[2] = loadAndResizeImage("assets/images/3.jpg", game->cellSize, game->cellSize);
-    game->assets[3] = loadAndResizeImage("assets/images/4.jpg", game->cellSize, game->cellSize);
-    game->assets[4] = loadAndResizeImage("assets/images/5.jpg", game->cellSize, game->cellSize);
-    game->assets[5] = loadAndResizeImage("assets/images/6.jpg", game->cellSize, game->cellSize);
-    game->assets[6] = loadAndResizeImage("assets/images/7.jpg", game->cellSize, game->cellSize);
-    game->assets[7] = loadAndResizeImage("assets/images/8.jpg", game->cellSize, game->cellSize);
-    game->assets[8] = loadAndResizeImage("assets/images/covered.jpg", game->cellSize, game->cellSize);
-    game->assets[9] = loadAndResizeImage("assets/images/empty.jpg", game->cellSize, game->cellSize);
-    game->assets[10] = loadAndResizeImage("assets/images/bomb.jpg", game->cellSize, game->cellSize);
-    game->assets[11] = loadAndResizeImage("assets/images/flag.jpg", game->cellSize, game->cellSize);
-
-    // Allocate memory for the grid (2D array of cells)
-    int i, j;
-    game->grid = (Cell **)malloc(game->rows * sizeof(Cell *));
-    if (!game->grid) {
-        printf("Failed to allocate memory\n");
-        gameState = GAME_OFF;  // End the game if memory allocation fails
-        return;
-    }
-
-    // Allocate memory for each row of cells in the grid
-    for (i = 0; i < game->rows; i++) {
-        game->grid[i] = (Cell *)malloc(game->cols * sizeof(Cell));
-        if (!game->grid[i]) {
+    // Set up the grid (rows, columns, mines and the seed used to place them on the first click). A grid of the
+    // same size as the previous game is cleared and reused, otherwise the old one is freed first
+    if (game->field.grid.mines && game->field.rows == gameRowsNum && game->field.cols == gameColsNum) {
+        restartMineField(&game->field, gameMinesNum, makeRandomSeed());
+    } else {
+        freeMineField(&game->field);
+        if (!initMineField(&game->field, gameRowsNum, gameColsNum, gameMinesNum, makeRandomSeed())) {
             printf("Failed to allocate memory\n");
-            gameState = GAME_OFF;
+            gameState = GAME_OFF;  // End the game if memory allocation fails
             return;
         }
-
-        // Initialize each cell with default values (no mines, not revealed, not flagged, and no adjacent mines)
-        for (j = 0; j < game->cols; j++) {
-            game->grid[i][j].isMine = 0;         // No mine
-            game->grid[i][j].isRevealed = 0;     // Cell not revealed
-            game->grid[i][j].isFlagged = 0;      // No flag
-            game->grid[i][j].adjacentMines = 0;  // No adjacent mines
-        }
     }
+
+    // Take the mines from the no-guess pool of the mode when the player asked for no-guess boards
+    game->field.pool = noGuessMode ? &boardPools[gameMode] : NULL;
+
+    // Log the revealed and flagged cells so the game screen only redraws those
+    trackBoardChanges(&game->field.grid);
+
+    // Fit the grid in the window and build the atlas of the cell images (numbers, bomb, flag, etc.) at its
+    // cell size, the atlas of the previous game is kept when the size is the same
+    fitGameView(game);
 }
 
 /**
@@ -85,195 +157,198 @@ void initializeGame(Game *game) {
  *
  * Parameters:
  *   - SDL_Surface *screen: The surface where the cell will be drawn (typically the game window).
- *   - Cell cell: The cell to be drawn, containing its state (revealed, flagged, etc.).
+ *   - int row: The row index of the cell in the grid.
+ *   - int col: The column index of the cell in the grid.
  *   - int x: The x-coordinate where the cell will be drawn on the screen.
  *   - int y: The y-coordinate where the cell will be drawn on the screen.
  *   - Game* game: The game state containing assets and other necessary data.
  */
-void drawCell(SDL_Surface *screen, Cell cell, int x, int y, Game* game) {
-    // Define the rectangle where the cell will be drawn, using its coordinates and size
-    SDL_Rect destRect = {x, y, game->cellSize, game->cellSize};
-
-    // Default image index (no image chosen)
-    int ImageIndex = -1;
-
-    // Check the state of the cell and select the appropriate image
-    if (cell.isRevealed) {
-        if (cell.isMine) {
-            // If the cell is revealed and is a mine, use the bomb image
-            ImageIndex = 10;
-        } else if (cell.adjacentMines > 0) {
-            // If the cell is revealed and has adjacent mines, show the number of adjacent mines
-            ImageIndex = cell.adjacentMines - 1;
-        } else {
-            // If the cell is revealed but has no adjacent mines, show the empty cell
-            ImageIndex = 9;
-        }
-    } else if (cell.isFlagged) {
-        // If the cell is flagged, show the flag image
-        ImageIndex = 11;
-    } else {
-        // If the cell is not revealed or flagged, show the covered image (cell is hidden)
-        ImageIndex = 8;
-    }
+void drawCell(SDL_Surface *screen, int row, int col, int x, int y, Game* game) {
+    // Draw the tile that shows the state of the cell (see cellTile)
+    drawTile(screen, &game->tiles, cellTile(&game->field.grid, row, col), x, y);
+}
 
-    // Draw the appropriate image at the given position
-    SDL_BlitSurface(game->assets[ImageIndex], NULL, screen, &destRect);
+/**
+ * Returns the area of the window covered by the timer.
+ */
+static SDL_Rect timerArea(void) {
+    SDL_Rect area = {screenWidth - 150, 20, 150, TTF_FontHeight(fonts[3])};
+    return area;
 }
 
 void drawTimer(SDL_Surface *screen, Game *game){
     game->elapsedTime =game->pausedTime + (SDL_GetTicks() - game->startTime)/1000 ; // Update elapsed time
-    char timeText[10];
+    char timeText[16];
     sprintf(timeText, "%02d:%02d", game->elapsedTime / 60, game->elapsedTime % 60);
     SDL_Color textColor = { 250, 250, 250 };
-    SDL_Surface* timeSurface = TTF_RenderText_Solid(fonts[3], timeText, textColor);
-    SDL_Rect timePosition = { .x = screenWidth-150, .y = 20 };  // Adjust position as needed
-    SDL_BlitSurface(timeSurface, NULL, screen, &timePosition);
-    SDL_FreeSurface(timeSurface);
+    // One blit per character from the digits rendered at startup, no text rendering or allocation per frame
+    drawDigits(screen, &digitAtlases[3], timeText, screenWidth - 150, 20, textColor);
 }
 
 /**
- * Draws the entire grid of cells on the game screen.
- * It iterates through each cell in the grid and draws it at the appropriate position
- * based on the current row and column, adjusting for cell size.
+ * Keeps a copy of the window under the timer (the background and the window image drawn by the full redraw),
+ * so drawGridChanges can erase the old time without redrawing the whole screen.
+ * The copy is reallocated when the window was resized (or its pixel format changed).
  *
  * Parameters:
- *   - SDL_Surface *screen: The surface where the grid will be drawn (typically the game window).
- *   - Game *game: The game state containing information about the grid (number of rows, columns, etc.)
- *                 and cell size.
+ *   - SDL_Surface *screen: The window surface, with everything but the timer and the grid drawn.
  */
-void drawGrid(SDL_Surface *screen, Game *game) {
-    // draw the timer on the screen
-    drawTimer(screen, game);
-
-    int i, j, shiftX, shiftY;
-    // Loop through all rows and columns in the grid
-    for (i = 0; i < game->rows; i++) {
-        for (j = 0; j < game->cols; j++) {
-            shiftX = (screenWidth-game->cellSize*game->cols)/2;
-            shiftY = screenHeight-game->cellSize*game->rows-50;
-            // Draw each cell at the calculated position (j * cellSize+ shiftX, i * cellSize + shiftY)
-            drawCell(screen, game->grid[i][j], (j * game->cellSize)+shiftX , (i * game->cellSize)+shiftY, game);
+static void saveTimerBackdrop(SDL_Surface *screen) {
+    SDL_Rect area = timerArea();
+    if (timerBackdrop && (timerBackdrop->w != area.w || timerBackdrop->h != area.h ||
+                          timerBackdrop->format->BitsPerPixel != screen->format->BitsPerPixel)) {
+        SDL_FreeSurface(timerBackdrop);
+        timerBackdrop = NULL;
+    }
+    if (!timerBackdrop) {
+        timerBackdrop = SDL_CreateRGBSurface(SDL_SWSURFACE, area.w, area.h, screen->format->BitsPerPixel,
+                                             screen->format->Rmask, screen->format->Gmask,
+                                             screen->format->Bmask, screen->format->Amask);
+        if (!timerBackdrop) {
+            return;
         }
     }
+    blitSurface(screen, &area, timerBackdrop, NULL);
 }
 
 /**
- * Places mines randomly on the grid, ensuring that the first clicked cell does not contain a mine.
- * It generates random coordinates and checks whether the cell already contains a mine or
- * is the first clicked cell before placing a mine.
+ * Moves the view of the grid to the part of the window it has after a resize, keeping the zoom and the scroll.
  *
  * Parameters:
- *   - Game *game: The game state, which includes the grid and the number of mines to place.
- *   - int firstClickRow: The row index of the first clicked cell (to avoid placing a mine there).
- *   - int firstClickCol: The column index of the first clicked cell (to avoid placing a mine there).
+ *   - Game *game: The game whose view is moved.
  */
-void placeMines(Game *game, int firstClickRow, int firstClickCol) {
-    srand(time(NULL));  // Seed the random number generator with current time
-    int minesPlaced = 0;
-
-    // Place mines until the required number of mines are placed
-    while (minesPlaced < game->numMines) {
-        // Generate random coordinates for a mine
-        int row = rand() % game->rows;
-        int col = rand() % game->cols;
-
-        // Ensure the mine is not placed on the first clicked cell
-        if ((row == firstClickRow && col == firstClickCol) || game->grid[row][col].isMine) {
-            continue; // Skip this iteration if the cell is already a mine or it's the first click
-        }
+void resizeGameView(Game *game) {
+    setViewportArea(&game->view, gridViewArea(game, game->view.cellSize));
+}
 
-        // Place the mine
-        game->grid[row][col].isMine = 1;
-        minesPlaced++;  // Increment the mine counter
-    }
+/**
+ * Zooms the grid in or out by one step (a quarter of the cell size, at least one pixel), keeping the cell under
+ * the mouse in place. The tile atlas is rebuilt at the new cell size.
+ *
+ * Parameters:
+ *   - Game *game: The game whose view is zoomed.
+ *   - int direction: 1 to zoom in, -1 to zoom out.
+ *   - int anchorX: The x-coordinate on the window that stays on the same cell (the mouse).
+ *   - int anchorY: The y-coordinate on the window that stays on the same cell.
+ *
+ * Returns:
+ *   - int: 1 if the cell size changed (the grid has to be redrawn), 0 if it was already at its limit.
+ */
+int zoomGameView(Game *game, int direction, int anchorX, int anchorY) {
+    int size = game->view.cellSize;
+    int step = size / 4 > 1 ? size / 4 : 1;
+    if (!zoomViewport(&game->view, direction > 0 ? size + step : size - step, anchorX, anchorY)) {
+        return 0;
+    }
+    resizeGameView(game);  // The grid may stop or start fitting in the window
+    loadGameAssets(game);
+    return 1;
 }
 
 /**
- * Calculates the number of adjacent mines for each cell in the grid.
- * It iterates over all cells, and for each non-mine cell, it checks the 8 neighboring cells
- * (up, down, left, right, and diagonals) to count how many mines are adjacent.
- * The result is stored in each cell's adjacentMines field.
+ * Scrolls the grid when it is larger than its part of the window.
  *
  * Parameters:
- *   - Game *game: The game state, which includes the grid and each cell's properties (mine status, adjacent mines, etc.).
+ *   - Game *game: The game whose view is scrolled.
+ *   - int dx: Pixels to scroll to the right (negative to the left).
+ *   - int dy: Pixels to scroll down (negative up).
+ *
+ * Returns:
+ *   - int: 1 if the grid moved (it has to be redrawn), 0 otherwise.
  */
-void calculateAdjacentMines(Game *game) {
-    int row, col;
-    // Iterate over every cell in the grid
-    for (row = 0; row < game->rows; row++) {
-        for (col = 0; col < game->cols; col++) {
-            if (game->grid[row][col].isMine) {
-                continue;  // Skip mines, they don't need to count their adjacent mines
-            }
+int panGameView(Game *game, int dx, int dy) {
+    return panViewport(&game->view, dx, dy);
+}
 
-            int adjacentMines = 0;
-
-            int i, j;
-            // Loop through the 8 possible neighbors (up, down, left, right, and diagonals)
-            for (i = -1; i <= 1; i++) {
-                for (j = -1; j <= 1; j++) {
-                    // Skip the current cell itself
-                    if (i == 0 && j == 0) continue;
-
-                    int neighborRow = row + i;
-                    int neighborCol = col + j;
-
-                    // Check if the neighbor is within bounds
-                    if (neighborRow >= 0 && neighborRow < game->rows && neighborCol >= 0 && neighborCol < game->cols) {
-                        // If the neighbor is a mine, increment the adjacent mine count
-                        if (game->grid[neighborRow][neighborCol].isMine) {
-                            adjacentMines++;
-                        }
-                    }
-                }
-            }
+/**
+ * Draws the entire grid of cells on the game screen.
+ * Only the cells inside the view are drawn, copied from the tile atlas row by row in one pass (see compositeGrid),
+ * so the cost follows the size of the window rather than the size of the board. When the frame is recorded for
+ * the frame bands, the grid is queued and drawn by the bands with the background and the window image.
+ * This is the full redraw (after the background and the window image); the cells logged since the last frame
+ * are drawn by it, so the change log is emptied, and the area under the timer is saved for drawGridChanges.
+ *
+ * Parameters:
+ *   - SDL_Surface *screen: The surface where the grid will be drawn (typically the game window).
+ *   - Game *game: The game state containing information about the grid (number of rows, columns, etc.)
+ *                 and cell size.
+ */
+void drawGrid(SDL_Surface *screen, Game *game) {
+    // draw the timer on the screen
+    saveTimerBackdrop(screen);
+    drawTimer(screen, game);
 
-            // Store the number of adjacent mines in the current cell
-            game->grid[row][col].adjacentMines = adjacentMines;
-        }
+    int shiftX, shiftY;
+    SDL_Rect visible = visibleGridArea(&game->view);
+    getViewportOrigin(&game->view, &shiftX, &shiftY);
+    if (!queueBandGrid(screen, &game->tiles, &game->field.grid, shiftX, shiftY, visible)) {
+        SDL_SetClipRect(screen, &visible);
+        compositeGrid(screen, &game->tiles, &game->field.grid, shiftX, shiftY);
+        SDL_SetClipRect(screen, NULL);
     }
+    resetBoardChanges(&game->field.grid);
 }
 
 /**
- * Performs a flood fill on the game grid starting from a specified cell.
- * The flood fill reveals all connected cells that have no adjacent mines.
- * It works recursively, revealing adjacent cells when the current cell has no adjacent mines.
- *
- * This implementation is inspired by the flood fill algorithm described in the following Wikipedia page:
- * https://en.wikipedia.org/wiki/Flood_fill#:~:text=The%20traditional%20flood-fill%20algorithm,them%20to%20the%20replacement%20color.
+ * Draws what changed on the game screen since the last frame, for the frames that aren't full redraws:
+ * the cells revealed or flagged (from the change log of the board) and the timer when its second changed.
+ * Every drawn area is marked in dirtyRects, so only those are pushed to the window.
+ * When the log can't tell what changed (not tracked, overflowed, board cleared) the whole grid is drawn.
+ * Cells outside the view are skipped.
  *
  * Parameters:
- *   - Game *game: The game state, which includes the grid of cells.
- *   - int row: The row index of the starting cell for the flood fill.
- *   - int col: The column index of the starting cell for the flood fill.
+ *   - SDL_Surface *screen: The window surface, showing the previous frame.
+ *   - Game *game: The game state containing the grid and the timer.
  */
-void floodFill(Game *game, int row, int col) {
-    // If the cell is out of bounds or already revealed, stop the flood fill
-    if (row < 0 || row >= game->rows || col < 0 || col >= game->cols) {
-        return;
+void drawGridChanges(SDL_Surface *screen, Game *game) {
+    Board *board = &game->field.grid;
+    int i, shiftX, shiftY;
+    int size = game->view.cellSize;
+    SDL_Rect visible = visibleGridArea(&game->view);
+    getViewportOrigin(&game->view, &shiftX, &shiftY);
+    SDL_SetClipRect(screen, &visible);
+
+    if (!board->changed || board->changedOverflow) {
+        compositeGrid(screen, &game->tiles, board, shiftX, shiftY);
+        markDirtyRect(&dirtyRects, visible);
+    } else {
+        for (i = 0; i < board->changedCount; i++) {
+            int row = board->changed[i] / game->field.cols;
+            int col = board->changed[i] % game->field.cols;
+            int x = col * size + shiftX, y = row * size + shiftY;
+            if (x + size <= visible.x || y + size <= visible.y || x >= visible.x + visible.w || y >= visible.y + visible.h) {
+                continue;  // Scrolled out of the view
+            }
+            SDL_Rect cellArea = {x, y, size, size};
+            clipToViewport(&game->view, &cellArea);
+            drawCell(screen, row, col, x, y, game);
+            markDirtyRect(&dirtyRects, cellArea);
+        }
     }
+    SDL_SetClipRect(screen, NULL);
+    resetBoardChanges(board);
 
-    // If the cell is already revealed, don't reveal it again
-    if (game->grid[row][col].isRevealed) {
-        return;
+    // Redraw the timer over its saved backdrop once per second
+    Uint32 elapsedTime = game->pausedTime + (SDL_GetTicks() - game->startTime) / 1000;
+    if (elapsedTime != game->elapsedTime && timerBackdrop) {
+        SDL_Rect area = timerArea();
+        blitSurface(timerBackdrop, NULL, screen, &area);
+        area = timerArea();  // The blit clips the destination rect
+        drawTimer(screen, game);
+        markDirtyRect(&dirtyRects, area);
     }
+}
 
-    // Reveal the current cell
-    game->grid[row][col].isRevealed = 1;
-
-    // If the cell has no adjacent mines, recursively reveal neighboring cells
-    if (game->grid[row][col].adjacentMines == 0) {
-        // Recursively reveal all adjacent cells
-        floodFill(game, row - 1, col);  // Up
-        floodFill(game, row + 1, col);  // Down
-        floodFill(game, row, col - 1);  // Left
-        floodFill(game, row, col + 1);  // Right
-        floodFill(game, row - 1, col - 1);  // Top-left diagonal
-        floodFill(game, row - 1, col + 1);  // Top-right diagonal
-        floodFill(game, row + 1, col - 1);  // Bottom-left diagonal
-        floodFill(game, row + 1, col + 1);  // Bottom-right diagonal
-    }
+/**
+ * Builds the tile atlas of the game again in the pixel format of the window, after the video mode changed.
+ * The pre-scaled levels don't depend on the window format, so no file is decoded again.
+ *
+ * Parameters:
+ *   - Game *game: The game whose tile atlas is rebuilt.
+ */
+void convertGameAssets(Game *game) {
+    freeTileAtlas(&game->tiles);
+    loadGameAssets(game);
 }
 
 void saveTimeIfBest(Game* game) {
@@ -316,26 +391,13 @@ void saveTimeIfBest(Game* game) {
     fclose(file);
 }
 
-int checkWin(Game* game) {
-    int i, j;
-    for (i = 0; i < game->rows; i++) {
-        for (j = 0; j < game->cols; j++) {
-            // If a non-mine cell is not revealed, the player hasn't won
-            if ((!game->grid[i][j].isMine) && !(game->grid[i][j].isRevealed)) {
-                return 0;
-            }
-        }
-    }
-    // save time if it's top 3
-    saveTimeIfBest(game);
-    return 1; // All conditions satisfied, player has won
-}
-
 /**
  * Handles a cell click event in the game. This function determines the clicked cell's position based on the mouse coordinates,
  * checks if the click is within the grid bounds, and processes the click accordingly.
  * If the user clicks for the first time, mines are placed on the grid, ensuring the first clicked cell is not a mine.
  * The flood fill is then performed starting from the clicked cell to reveal all connected empty cells.
+ * The rules themselves are applied by revealCell from the engine, this function only maps the mouse position
+ * to a cell, starts the timer and updates the player stats and the screen when the game is won or lost.
  *
  * Parameters:
  *   - Game *game: The current game state, which includes the grid and other necessary data.
@@ -343,47 +405,32 @@ int checkWin(Game* game) {
  *   - int mouseY: The y-coordinate of the mouse click, which determines the row.
  */
 void handleCellClick(Game *game, int mouseX, int mouseY, PlayerStats *playerStats) {
-    // Calculate grid coordinates
-    int shiftX = (screenWidth - game->cellSize * game->cols) / 2;
-    int shiftY = screenHeight - game->cellSize * game->rows - 50;
-    int col = (mouseX - shiftX) / game->cellSize;
-    int row = (mouseY - shiftY) / game->cellSize;
-
-    // Check if click is within grid bounds
-    if (row < 0 || row >= game->rows || col < 0 || col >= game->cols) {
+    // Find the clicked cell through the view the grid is drawn with
+    int row, col;
+    if (!viewportCellAt(&game->view, mouseX, mouseY, &row, &col)) {
         return;
     }
 
-    Cell *clickedCell = &game->grid[row][col];
+    // Reveal the cell (the engine places the mines on the first click)
+    int firstClick = game->field.firstClick;
+    int previousState = game->field.gameState;
+    revealCell(&game->field, row, col);
 
-    // First click: Place mines and calculate adjacent mines
-    if (!game->firstClick) {
-        placeMines(game, row, col);
-        calculateAdjacentMines(game);
+    if (!firstClick && game->field.firstClick) {
         game->startTime = SDL_GetTicks();  // Start the timer
-        game->firstClick = 1;
     }
 
-    // Process cell based on its state
-    if (clickedCell->isFlagged || clickedCell->isRevealed) {
-        return;  // Ignore clicks on flagged or already revealed cells
+    if (game->field.gameState == previousState) {
+        return;
     }
 
-    if (clickedCell->isMine) {
-        game->gameState = 1;
+    if (game->field.gameState == 1) {
         playerStats->gamesPlayed++;
         playerStats->WinStreak = 0;
         currentScreen = 5;
-        return;
-    }
-
-    if (clickedCell->adjacentMines == 0) {
-        floodFill(game, row, col);  // Reveal empty region
-    } else {
-        clickedCell->isRevealed = 1;  // Reveal the clicked cell
-    }
-    if (checkWin(game)==1) {
-        game->gameState = 2;
+    } else if (game->field.gameState == 2) {
+        // save time if it's top 3
+        saveTimeIfBest(game);
         playerStats->gamesPlayed++;
         playerStats->gamesWon++;
         playerStats->WinStreak++;
@@ -392,30 +439,14 @@ void handleCellClick(Game *game, int mouseX, int mouseY, PlayerStats *playerStat
 }
 
 void handleFlagClick(Game *game, int mouseX, int mouseY) {
-    // Calculate grid coordinates
-    int shiftX = (screenWidth - game->cellSize * game->cols) / 2;
-    int shiftY = screenHeight - game->cellSize * game->rows - 50;
-    int col = (mouseX - shiftX) / game->cellSize;
-    int row = (mouseY - shiftY) / game->cellSize;
-
-    // Check if click is within grid bounds
-    if (row < 0 || row >= game->rows || col < 0 || col >= game->cols) {
+    // Find the clicked cell through the view the grid is drawn with
+    int row, col;
+    if (!viewportCellAt(&game->view, mouseX, mouseY, &row, &col)) {
         return;
     }
 
-    Cell *clickedCell = &game->grid[row][col];
-
-    // Process cell based on its state
-    if (!clickedCell->isRevealed) {
-        clickedCell->isFlagged = !clickedCell->isFlagged;
-
-        // Update the count of flagged cells
-        if (clickedCell->isFlagged) {
-            game->flagCount++;
-        } else {
-            game->flagCount--;
-        }
-    }
+    // Flag or unflag the cell if it's still covered
+    toggleFlag(&game->field, row, col);
 }
 
 
@@ -438,23 +469,17 @@ void saveGameGrid(Game *game, const char *filename) {
     game->pausedTime = game->elapsedTime;
 
     // Write rows and cols
-    fwrite(&game->gameState, sizeof(int), 1, file);
-    fwrite(&game->firstClick, sizeof(int), 1, file);
-    fwrite(&game->rows, sizeof(int), 1, file);
-    fwrite(&game->cols, sizeof(int), 1, file);
-    fwrite(&game->numMines, sizeof(int), 1, file);
-    fwrite(&game->flagCount, sizeof(int), 1, file);
+    fwrite(&game->field.gameState, sizeof(int), 1, file);
+    fwrite(&game->field.firstClick, sizeof(int), 1, file);
+    fwrite(&game->field.rows, sizeof(int), 1, file);
+    fwrite(&game->field.cols, sizeof(int), 1, file);
+    fwrite(&game->field.numMines, sizeof(int), 1, file);
+    fwrite(&game->field.flagCount, sizeof(int), 1, file);
     fwrite(&game->cellSize, sizeof(int), 1, file);
     fwrite(&game->pausedTime, sizeof(Uint32), 1, file);
 
-    // Write grid data
-    int i,j;
-    for (i = 0; i < game->rows; i++) {
-        for (j = 0; j < game->cols; j++) {
-            // Write each Cell data
-            fwrite(&game->grid[i][j], sizeof(Cell), 1, file);
-        }
-    }
+    // Write grid data, one Cell record per cell so the file layout stays the same
+    saveMineFieldCells(&game->field, file);
 
     fclose(file); // Close the file
 }
@@ -462,6 +487,7 @@ void saveGameGrid(Game *game, const char *filename) {
 /**
  * Loads the game grid, including rows, columns, and cell data, from a binary .dat file.
  * This function also loads necessary images and reallocates memory for the grid based on the data in the file.
+ * The count of covered safe cells isn't stored in the file, it is rebuilt from the loaded grid.
  *
  * Parameters:
  *   - Game *game: The game state object where the loaded data will be stored.
@@ -475,42 +501,25 @@ void loadGameGrid(Game *game, const char *filename) {
     }
 
     // Read rows and cols
-    fread(&game->gameState, sizeof(int), 1, file);
-    fread(&game->firstClick, sizeof(int), 1, file);
-    fread(&game->rows, sizeof(int), 1, file);
-    fread(&game->cols, sizeof(int), 1, file);
-    fread(&game->numMines, sizeof(int), 1, file);
-    fread(&game->flagCount, sizeof(int), 1, file);
+    fread(&game->field.gameState, sizeof(int), 1, file);
+    fread(&game->field.firstClick, sizeof(int), 1, file);
+    fread(&game->field.rows, sizeof(int), 1, file);
+    fread(&game->field.cols, sizeof(int), 1, file);
+    fread(&game->field.numMines, sizeof(int), 1, file);
+    fread(&game->field.flagCount, sizeof(int), 1, file);
     fread(&game->cellSize, sizeof(int), 1, file);
     fread(&game->pausedTime, sizeof(Uint32), 1, file);
 
 
-    // Load images
-    game->assets[0] = loadAndResizeImage("assets/images/1.jpg", game->cellSize, game->cellSize);
-    game->assets[1] = loadAndResizeImage("assets/images/2.jpg", game->cellSize, game->cellSize);
-    game->assets[2] = loadAndResizeImage("assets/images/3.jpg", game->cellSize, game->cellSize);
-    game->assets[3] = loadAndResizeImage("assets/images/4.jpg", game->cellSize, game->cellSize);
-    game->assets[4] = loadAndResizeImage("assets/images/5.jpg", game->cellSize, game->cellSize);
-    game->assets[5] = loadAndResizeImage("assets/images/6.jpg", game->cellSize, game->cellSize);
-    game->assets[6] = loadAndResizeImage("assets/images/7.jpg", game->cellSize, game->cellSize);
-    game->assets[7] = loadAndResizeImage("assets/images/8.jpg", game->cellSize, game->cellSize);
-    game->assets[8] = loadAndResizeImage("assets/images/covered.jpg", game->cellSize, game->cellSize);
-    game->assets[9] = loadAndResizeImage("assets/images/empty.jpg", game->cellSize, game->cellSize);
-    game->assets[10] = loadAndResizeImage("assets/images/bomb.jpg", game->cellSize, game->cellSize);
-    game->assets[11] = loadAndResizeImage("assets/images/flag.jpg", game->cellSize, game->cellSize);
-
-    // Allocate memory for the grid
-    int i,j;
-    game->grid = (Cell **)malloc(game->rows * sizeof(Cell *));
-    for (i = 0; i < game->rows; i++) {
-        game->grid[i] = (Cell *)malloc(game->cols * sizeof(Cell));
-    }
-
-    // Read grid data
-    for (i = 0; i < game->rows; i++) {
-        for (j = 0; j < game->cols; j++) {
-            fread(&game->grid[i][j], sizeof(Cell), 1, file);
-        }
+    // Fit the loaded grid in the window and build its images
+    fitGameView(game);
+
+    // Read grid data (the engine reallocates the grid and rebuilds the count of covered safe cells)
+    if (!loadMineFieldCells(&game->field, file)) {
+        printf("Failed to allocate memory\n");
+        gameState = GAME_OFF;
+    } else {
+        trackBoardChanges(&game->field.grid);  // The new grid starts a new change log
     }
 
     fclose(file); // Close the file
@@ -524,19 +533,15 @@ void loadGameGrid(Game *game, const char *filename) {
  *   - Game *game: The game state object containing the allocated memory to be freed.
  */
 void freeGameGrid(Game *game) {
-    int i;
-    // Free memory allocated for images (assets)
-    for(i = 0; i < 12; i++) {
-        free(game->assets[i]);
-    }
-    free(game->assets); // Free the array of assets
+    // Free the tile atlas of the cell images and the levels it is built from
+    freeTileAtlas(&game->tiles);
+    freeTileLevels(&cellLevels);
 
-    // Free memory allocated for the grid cells
-    for (i = 0; i < game->rows; i++) {
-        free(game->grid[i]);
-    }
-    free(game->grid); // Free the grid itself
-    game->grid = NULL; // Set the grid pointer to NULL to avoid dangling references
+    // Free the packed grid (its pointers are set to NULL to avoid dangling references)
+    freeMineField(&game->field);
+
+    SDL_FreeSurface(timerBackdrop);
+    timerBackdrop = NULL;
 }
 
 
@@ -636,64 +641,91 @@ void initializeAchievements(Achievement achievements[], PlayerStats *playerStats
 
 }
 
+// Function told about every achievement checkAchievements unlocks, and the data it is given
+static AchievementUnlockedHandler unlockHandler = NULL;
+static void *unlockContext = NULL;
+
+/**
+ * Sets the function told about every achievement that gets unlocked, so the screens showing the achievements
+ * can be patched instead of rebuilt.
+ *
+ * Parameters:
+ *   - AchievementUnlockedHandler handler: The function to call (NULL for none).
+ *   - void *context: Data given back to the function on every call.
+ */
+void setAchievementUnlockedHandler(AchievementUnlockedHandler handler, void *context) {
+    unlockHandler = handler;
+    unlockContext = context;
+}
+
+/**
+ * Unlocks an achievement and tells the unlock handler about it.
+ */
+static void unlockAchievement(Achievement achievements[], int index) {
+    achievements[index].isUnlocked = 1;
+    if (unlockHandler) {
+        unlockHandler(unlockContext, index);
+    }
+}
+
 void checkAchievements(Achievement achievements[], PlayerStats playerStats, Game game) {
     // Win a game
     if (playerStats.gamesWon == 1 && achievements[0].isUnlocked == 0) {
-        achievements[0].isUnlocked = 1;
+        unlockAchievement(achievements, 0);
     }
 
     // Win a game under 5 minutes
-    if (game.gameState == 2 && game.elapsedTime < 300 && achievements[1].isUnlocked == 0) {
-        achievements[1].isUnlocked = 1;
+    if (game.field.gameState == 2 && game.elapsedTime < 300 && achievements[1].isUnlocked == 0) {
+        unlockAchievement(achievements, 1);
     }
 
     // Play 10 games
     if (playerStats.gamesPlayed == 10 && achievements[2].isUnlocked == 0) {
-        achievements[2].isUnlocked = 1;
+        unlockAchievement(achievements, 2);
     }
 
     // Play 50 games
     if (playerStats.gamesPlayed == 50 && achievements[3].isUnlocked == 0) {
-        achievements[3].isUnlocked = 1;
+        unlockAchievement(achievements, 3);
     }
 
     // Play 100 games
     if (playerStats.gamesPlayed == 100 && achievements[4].isUnlocked == 0) {
-        achievements[4].isUnlocked = 1;
+        unlockAchievement(achievements, 4);
     }
 
     // Win 2 games in a row
     if (playerStats.WinStreak == 2 && achievements[5].isUnlocked == 0) {
-        achievements[5].isUnlocked = 1;
+        unlockAchievement(achievements, 5);
     }
 
     // Win 10 games
     if (playerStats.gamesWon == 10 && achievements[6].isUnlocked == 0) {
-        achievements[6].isUnlocked = 1;
+        unlockAchievement(achievements, 6);
     }
 
      // Play 500 games
     if (playerStats.gamesPlayed == 500 && achievements[7].isUnlocked == 0) {
-        achievements[7].isUnlocked = 1;
+        unlockAchievement(achievements, 7);
     }
 
     // Win a game under 8 minutes
-    if (game.gameState == 2 && game.elapsedTime < 480 && achievements[8].isUnlocked == 0) {
-        achievements[8].isUnlocked = 1;
+    if (game.field.gameState == 2 && game.elapsedTime < 480 && achievements[8].isUnlocked == 0) {
+        unlockAchievement(achievements, 8);
     }
 
     // Win 5 games in a row
     if (playerStats.WinStreak == 5 && achievements[9].isUnlocked == 0) {
-        achievements[9].isUnlocked = 1;
+        unlockAchievement(achievements, 9);
     }
 
     // Win 100 games
     if (playerStats.gamesWon == 100 && achievements[10].isUnlocked == 0) {
-        achievements[10].isUnlocked = 1;
+        unlockAchievement(achievements, 10);
     }
 
     // Play 1000 games
     if (playerStats.gamesPlayed == 1000 && achievements[11].isUnlocked == 0) {
-        achievements[11].isUnlocked = 1;
+        unlockAchievement(achievements, 11);
     }
 }
@@ -0,0 +1,29 @@
+#include "../include/struct.h"
+
+/**
+ * Global variables of the front end (declared in struct.h). They live here rather than in main.c so that the
+ * game and the screen harness, which has its own main, link the same definitions.
+ */
+
+int screenWidth = 1100;  // Width of the window
+int screenHeight = 700;  // Height of the window
+
+int currentScreen = 0;  // Tracks the current screen (0: menu, 1: game, etc.)
+GameState gameState = GAME_ON;  // Initial game state is "on"
+int frameTimer = 0;  // Timer for controlling frame rate
+GameMode gameMode = MODE_EASY;  // Default game mode is easy
+int noGuessMode = 0;  // New games use random boards until no-guess boards are asked for
+BoardPool boardPools[NUM_MODE_PRESETS];  // Ready no-guess boards of each mode
+
+// Game grid and cell size
+int gameRowsNum = 0;
+int gameColsNum = 0;
+int gameMinesNum = 0;
+int cellSize = 1;
+
+// Array to store fonts for rendering text
+TTF_Font *fonts[NUM_FONTS];
+DigitAtlas digitAtlases[NUM_FONTS];  // Digits of each font, rendered once
+
+// Areas of the window drawn during the current frame
+DirtyRects dirtyRects;
@@ -0,0 +1,501 @@
+#include "../include/no_guess.h"
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Candidates tried by each worker per round of the parallel search
+#define CANDIDATES_PER_WORKER 8
+
+// Shared state of one parallel search for a no-guess board
+typedef struct {
+    int numMines;
+    int startRow;
+    int startCol;
+    uint64_t seed;             // Candidate i is placed with seed + i
+    long base;                 // Index of the first candidate of the current round
+    long best;                 // Lowest accepted candidate index so far (NO_GUESS_MAX_CANDIDATES while none)
+    MineField *fields;         // One scratch field per worker
+    Solver *solvers;           // One solver per worker
+} NoGuessSearch;
+
+/**
+ * Checks if a field can be cleared from a cell by deduction alone: the cell is revealed, then the solver is run
+ * and every cell it proves safe is revealed, until the game is won or the solver has no safe cell left.
+ * The mines and the adjacent counts of the field must already be placed. The revealed and flagged planes are
+ * overwritten, so this is meant for scratch fields (the revealed plane holds the reached position afterwards).
+ *
+ * Parameters:
+ *   - MineField *field: The field with its mines placed.
+ *   - Solver *solver: The solver to use (resized for the field if needed).
+ *   - int row: The row index of the first click.
+ *   - int col: The column index of the first click.
+ *
+ * Returns:
+ *   - int: 1 if the whole board gets cleared without guessing, 0 otherwise.
+ */
+int isSolvableWithoutGuessing(MineField *field, Solver *solver, int row, int col) {
+    Board *board = &field->grid;
+    size_t planeBytes = board->planeWords * sizeof(uint32_t);
+    int cells = field->rows * field->cols;
+    int index;
+
+    memset(board->revealed, 0, planeBytes);
+    memset(board->flagged, 0, planeBytes);
+    field->gameState = 0;
+    field->firstClick = 1;  // The mines are already there, the reveal must not place new ones
+    field->flagCount = 0;
+    field->safeCellsLeft = cells - field->numMines;
+
+    revealCell(field, row, col);
+    while (field->gameState == 0) {
+        if (!solveMineField(solver, field) || solver->knownSafe == 0) {
+            return 0;  // A guess would be needed (or the solver ran out of memory)
+        }
+        for (index = 0; index < cells && field->gameState == 0; index++) {
+            if (solver->state[index] == SOLVER_SAFE) {
+                revealCell(field, index / field->cols, index % field->cols);
+            }
+        }
+    }
+    return field->gameState == 2;
+}
+
+/**
+ * Places the mines of one candidate on a board (the mine plane only, the other planes are left alone).
+ */
+static int placeCandidate(Board *board, int numMines, int startRow, int startCol, uint64_t seed) {
+    RandomState rng;
+    seedRandom(&rng, seed);
+    memset(board->mines, 0, board->planeWords * sizeof(uint32_t));
+    return placeBoardMines(board, numMines, startRow, startCol, &rng);
+}
+
+/**
+ * Tries the candidates of a chunk and keeps the lowest accepted index. Candidates above an accepted one are
+ * skipped, since they can't win any more.
+ */
+static void tryCandidates(void *context, int worker, long begin, long end) {
+    NoGuessSearch *search = context;
+    MineField *field = &search->fields[worker];
+    long i;
+
+    for (i = begin; i < end; i++) {
+        long candidate = search->base + i;
+        long best = __atomic_load_n(&search->best, __ATOMIC_RELAXED);
+        if (candidate >= best) return;
+
+        field->numMines = placeCandidate(&field->grid, search->numMines, search->startRow, search->startCol, search->seed + (uint64_t)candidate);
+        computeAdjacentMines(&field->grid);
+        if (!isSolvableWithoutGuessing(field, &search->solvers[worker], search->startRow, search->startCol)) continue;
+
+        // Lower the best index unless another worker found a lower one meanwhile
+        while (candidate < best && !__atomic_compare_exchange_n(&search->best, &best, candidate, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+        return;
+    }
+}
+
+/**
+ * Places mines on the board so that it can be cleared from the first click without guessing. Candidates are
+ * placed like random boards (seed + candidate index, first click and its neighbours kept free) and checked with
+ * isSolvableWithoutGuessing, a round of CANDIDATES_PER_WORKER candidates per worker at a time with parallelFor.
+ * The lowest accepted candidate of a round is kept, so the board depends only on the seed, not on the threads.
+ * Only the mine plane of the board is written; the adjacent counts must be computed afterwards.
+ *
+ * Parameters:
+ *   - Board *board: The board to place the mines on.
+ *   - int numMines: Number of mines to place.
+ *   - int firstClickRow: The row index of the first click.
+ *   - int firstClickCol: The column index of the first click.
+ *   - uint64_t seed: Seed of the first candidate.
+ *   - int workers: Number of threads to use (0 or less for every core).
+ *
+ * Returns:
+ *   - int: 1 if a board was placed, 0 if no candidate was accepted (the board is left unchanged) or on failure.
+ */
+int generateNoGuessMines(Board *board, int numMines, int firstClickRow, int firstClickCol, uint64_t seed, int workers) {
+    NoGuessSearch search;
+    int i, ready = 0, found = 0;
+
+    if (workers <= 0) {
+        workers = getCoreCount();
+    }
+
+    search.numMines = numMines;
+    search.startRow = firstClickRow;
+    search.startCol = firstClickCol;
+    search.seed = seed;
+    search.best = NO_GUESS_MAX_CANDIDATES;
+    search.fields = calloc(workers, sizeof(MineField));
+    search.solvers = calloc(workers, sizeof(Solver));
+    if (!search.fields || !search.solvers) {
+        printf("Memory allocation failed for the no-guess search\n");
+        free(search.fields);
+        free(search.solvers);
+        return 0;
+    }
+    for (ready = 0; ready < workers; ready++) {
+        if (!initMineField(&search.fields[ready], board->rows, board->cols, numMines, 0)) break;
+        if (!initSolver(&search.solvers[ready], board->rows, board->cols)) {
+            freeMineField(&search.fields[ready]);
+            break;
+        }
+    }
+
+    if (ready == workers) {
+        long round = (long)workers * CANDIDATES_PER_WORKER;
+        for (search.base = 0; search.base < NO_GUESS_MAX_CANDIDATES; search.base += round) {
+            if (!parallelFor(round, 1, workers, tryCandidates, &search)) break;
+            if (search.best < NO_GUESS_MAX_CANDIDATES) {
+                // Replay the accepted candidate on the board
+                placeCandidate(board, numMines, firstClickRow, firstClickCol, seed + (uint64_t)search.best);
+                found = 1;
+                break;
+            }
+        }
+    } else {
+        printf("Memory allocation failed for the no-guess search\n");
+    }
+
+    for (i = 0; i < ready; i++) {
+        freeSolver(&search.solvers[i]);
+        freeMineField(&search.fields[i]);
+    }
+    free(search.fields);
+    free(search.solvers);
+    return found;
+}
+
+/**POOL**/
+
+/**
+ * Maps a cell of a stored board to the board that is played with one of its symmetries: transposed first
+ * (bit 2, square boards only), then the rows flipped (bit 1), then the columns flipped (bit 0).
+ */
+static int transformCell(const BoardPool *pool, int transform, int row, int col) {
+    if (transform & 4) {
+        int swap = row;
+        row = col;
+        col = swap;
+    }
+    if (transform & 2) row = pool->rows - 1 - row;
+    if (transform & 1) col = pool->cols - 1 - col;
+    return row * pool->cols + col;
+}
+
+/**
+ * Maps a cell of the played board back to the stored board (inverse of transformCell).
+ */
+static int untransformCell(const BoardPool *pool, int transform, int row, int col) {
+    if (transform & 1) col = pool->cols - 1 - col;
+    if (transform & 2) row = pool->rows - 1 - row;
+    if (transform & 4) {
+        int swap = row;
+        row = col;
+        col = swap;
+    }
+    return row * pool->cols + col;
+}
+
+/**
+ * Makes room for one more board in the pool (the lock must be held).
+ */
+static int reservePoolEntry(BoardPool *pool) {
+    if (pool->count < pool->capacity) {
+        return 1;
+    }
+    int capacity = pool->capacity ? pool->capacity * 2 : BOARD_POOL_TARGET;
+    uint32_t *entries = realloc(pool->entries, (size_t)capacity * 2 * pool->planeWords * sizeof(uint32_t));
+    if (!entries) {
+        printf("Memory allocation failed for the board pool\n");
+        return 0;
+    }
+    pool->entries = entries;
+    pool->capacity = capacity;
+    return 1;
+}
+
+/**
+ * Sets up an empty pool for boards of a mode and loads the boards saved in its file, if the file exists and
+ * was written for the same board size and mine count.
+ * File layout: rows, cols, numMines, count (ints), then for every board its mine plane and its start plane.
+ *
+ * Parameters:
+ *   - BoardPool *pool: The pool to set up.
+ *   - int rows: Number of rows of the boards.
+ *   - int cols: Number of columns of the boards.
+ *   - int numMines: Number of mines of the boards.
+ *   - const char *filename: File the pool is loaded from and saved to (NULL keeps it in memory only).
+ *
+ * Returns:
+ *   - int: 1 if the pool was set up, 0 on failure.
+ */
+int initBoardPool(BoardPool *pool, int rows, int cols, int numMines, const char *filename) {
+    memset(pool, 0, sizeof(BoardPool));
+    pool->rows = rows;
+    pool->cols = cols;
+    pool->numMines = numMines;
+    pool->planeWords = (rows * cols + 31) / 32;
+    pool->target = BOARD_POOL_TARGET;
+    pool->filename = filename;
+    seedRandom(&pool->rng, makeRandomSeed());
+    if (pthread_mutex_init(&pool->lock, NULL) != 0 || pthread_cond_init(&pool->wake, NULL) != 0) {
+        return 0;
+    }
+
+    FILE *file = filename ? fopen(filename, "rb") : NULL;
+    if (file) {
+        int header[4];
+        if (fread(header, sizeof(int), 4, file) == 4 && header[0] == rows && header[1] == cols && header[2] == numMines) {
+            while (pool->count < header[3] && reservePoolEntry(pool)) {
+                size_t words = 2 * (size_t)pool->planeWords;
+                if (fread(pool->entries + pool->count * words, sizeof(uint32_t), words, file) != words) break;
+                pool->count++;
+            }
+        }
+        fclose(file);
+    }
+    return 1;
+}
+
+/**
+ * Generates one board for the pool: a no-guess board for a random start cell, then the plane of every cell it
+ * can be started from. Those are the zero cells of every opening the board can be cleared from (a click on any
+ * zero cell of an opening reveals the same cells).
+ */
+static int generatePoolEntry(BoardPool *pool, MineField *field, Solver *solver, uint32_t *entry, uint32_t *opening) {
+    Board *board = &field->grid;
+    size_t planeBytes = pool->planeWords * sizeof(uint32_t);
+    uint32_t *starts = entry + pool->planeWords;
+    int cells = pool->rows * pool->cols;
+    int index, row, col, startRow, startCol;
+    uint64_t seed;
+
+    pthread_mutex_lock(&pool->lock);
+    startRow = randomBelow(&pool->rng, pool->rows);
+    startCol = randomBelow(&pool->rng, pool->cols);
+    seed = nextRandom(&pool->rng);
+    pthread_mutex_unlock(&pool->lock);
+
+    field->numMines = pool->numMines;
+    if (!generateNoGuessMines(board, pool->numMines, startRow, startCol, seed, pool->workers)) {
+        return 0;
+    }
+    computeAdjacentMines(board);
+    memcpy(entry, board->mines, planeBytes);
+    memset(starts, 0, planeBytes);
+
+    // Zero cells whose opening has been checked already
+    uint32_t *tried = malloc(planeBytes);
+    if (!tried) {
+        printf("Memory allocation failed for the board pool\n");
+        return 0;
+    }
+    memset(tried, 0, planeBytes);
+
+    for (index = 0; index < cells; index++) {
+        row = index / pool->cols;
+        col = index % pool->cols;
+        if (getBoardBit(tried, index) || getBoardBit(board->mines, index) || getAdjacentMines(board, row, col) != 0) continue;
+
+        // Keep the opening of the cell, the solvability check overwrites the revealed plane
+        memset(board->revealed, 0, planeBytes);
+        floodRevealBoard(board, row, col);
+        memcpy(opening, board->revealed, planeBytes);
+        int solvable = isSolvableWithoutGuessing(field, solver, row, col);
+
+        int other;
+        for (other = index; other < cells; other++) {
+            if (getBoardBit(opening, other) && getAdjacentMines(board, other / pool->cols, other % pool->cols) == 0) {
+                setBoardBit(tried, other, 1);
+                if (solvable) setBoardBit(starts, other, 1);
+            }
+        }
+    }
+    free(tried);
+    return 1;
+}
+
+/**
+ * Body of the refill thread: waits while the pool is full and generates a board (without holding the lock)
+ * whenever one is missing, until the pool is freed.
+ */
+static void *refillBoardPool(void *argument) {
+    BoardPool *pool = argument;
+    MineField field;
+    Solver solver;
+    size_t planeBytes = pool->planeWords * sizeof(uint32_t);
+    uint32_t *entry = malloc(2 * planeBytes);
+    uint32_t *opening = malloc(planeBytes);
+
+    if (!entry || !opening || !initMineField(&field, pool->rows, pool->cols, pool->numMines, 0)) {
+        printf("Memory allocation failed for the board pool\n");
+        free(entry);
+        free(opening);
+        return NULL;
+    }
+    if (!initSolver(&solver, pool->rows, pool->cols)) {
+        freeMineField(&field);
+        free(entry);
+        free(opening);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stopping) {
+        if (pool->count >= pool->target) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        int generated = generatePoolEntry(pool, &field, &solver, entry, opening);
+        pthread_mutex_lock(&pool->lock);
+
+        if (!generated) break;  // This mode has no no-guess boards within the candidate budget
+        if (reservePoolEntry(pool)) {
+            memcpy(pool->entries + pool->count * 2 * (size_t)pool->planeWords, entry, 2 * planeBytes);
+            pool->count++;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    freeSolver(&solver);
+    freeMineField(&field);
+    free(entry);
+    free(opening);
+    return NULL;
+}
+
+/**
+ * Starts the background thread that keeps BOARD_POOL_TARGET boards in the pool.
+ *
+ * Parameters:
+ *   - BoardPool *pool: The pool to fill.
+ *   - int workers: Number of threads used to generate one board (0 or less for every core but the game's).
+ *
+ * Returns:
+ *   - int: 1 if the thread was started, 0 on failure.
+ */
+int startBoardPoolRefill(BoardPool *pool, int workers) {
+    if (workers <= 0) {
+        workers = getCoreCount() > 1 ? getCoreCount() - 1 : 1;
+    }
+    pool->workers = workers;
+    pool->stopping = 0;
+    if (pthread_create(&pool->thread, NULL, refillBoardPool, pool) != 0) {
+        printf("Failed to start the board pool thread\n");
+        return 0;
+    }
+    pool->running = 1;
+    return 1;
+}
+
+/**
+ * Takes a pooled board that can be started from the first click, trying every symmetry of every board, and
+ * places its mines (transformed to fit the click) on the board. The board is removed from the pool and the
+ * refill thread is woken up to replace it.
+ *
+ * Parameters:
+ *   - BoardPool *pool: The pool to take the board from.
+ *   - Board *board: The board to place the mines on (must have the size of the pool's boards).
+ *   - int firstClickRow: The row index of the first click.
+ *   - int firstClickCol: The column index of the first click.
+ *
+ * Returns:
+ *   - int: 1 if a board was placed, 0 if none fits the click (the board is left unchanged).
+ */
+int takePooledBoard(BoardPool *pool, Board *board, int firstClickRow, int firstClickCol) {
+    int transforms = pool->rows == pool->cols ? 8 : 4;
+    size_t words = 2 * (size_t)pool->planeWords;
+    int cells = pool->rows * pool->cols;
+    int entry, transform = 0, index;
+
+    if (board->rows != pool->rows || board->cols != pool->cols) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    for (entry = 0; entry < pool->count; entry++) {
+        uint32_t *starts = pool->entries + entry * words + pool->planeWords;
+        for (transform = 0; transform < transforms; transform++) {
+            if (getBoardBit(starts, untransformCell(pool, transform, firstClickRow, firstClickCol))) break;
+        }
+        if (transform < transforms) break;
+    }
+
+    if (entry == pool->count) {
+        pool->misses++;
+        pthread_mutex_unlock(&pool->lock);
+        return 0;
+    }
+
+    uint32_t *mines = pool->entries + entry * words;
+    memset(board->mines, 0, pool->planeWords * sizeof(uint32_t));
+    for (index = 0; index < cells; index++) {
+        if (getBoardBit(mines, index)) {
+            setBoardBit(board->mines, transformCell(pool, transform, index / pool->cols, index % pool->cols), 1);
+        }
+    }
+
+    // Fill the hole with the last board
+    pool->count--;
+    if (entry != pool->count) {
+        memcpy(mines, pool->entries + pool->count * words, words * sizeof(uint32_t));
+    }
+    pool->hits++;
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+/**
+ * Writes the boards of the pool to its file (see initBoardPool for the layout).
+ *
+ * Parameters:
+ *   - BoardPool *pool: The pool to save.
+ *
+ * Returns:
+ *   - int: 1 if the file was written, 0 otherwise.
+ */
+int saveBoardPool(BoardPool *pool) {
+    if (!pool->filename) {
+        return 0;
+    }
+    FILE *file = fopen(pool->filename, "wb");
+    if (!file) {
+        perror("Error opening board pool file");
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    int header[4] = {pool->rows, pool->cols, pool->numMines, pool->count};
+    fwrite(header, sizeof(int), 4, file);
+    fwrite(pool->entries, sizeof(uint32_t), (size_t)pool->count * 2 * pool->planeWords, file);
+    pthread_mutex_unlock(&pool->lock);
+
+    fclose(file);
+    return 1;
+}
+
+/**
+ * Stops the refill thread (waiting for the board it is generating), saves the pool and frees its memory.
+ *
+ * Parameters:
+ *   - BoardPool *pool: The pool to free.
+ */
+void freeBoardPool(BoardPool *pool) {
+    if (pool->running) {
+        pthread_mutex_lock(&pool->lock);
+        pool->stopping = 1;
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+        pthread_join(pool->thread, NULL);
+        pool->running = 0;
+    }
+    saveBoardPool(pool);
+    free(pool->entries);
+    pool->entries = NULL;
+    pool->count = pool->capacity = 0;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+}
@@ -0,0 +1,92 @@
+#include "../include/rng.h"
+#include <time.h>
+
+/**
+ * SplitMix64 step, used to spread a single 64-bit seed over the generator state.
+ */
+static uint64_t splitMix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Seeds the generator. The same seed always gives the same sequence of numbers.
+ *
+ * Parameters:
+ *   - RandomState *rng: The generator to seed.
+ *   - uint64_t seed: Any 64-bit value.
+ */
+void seedRandom(RandomState *rng, uint64_t seed) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        rng->state[i] = splitMix64(&seed);
+    }
+}
+
+/**
+ * Returns the next number of the xoshiro256** sequence.
+ * Reference: https://prng.di.unimi.it/xoshiro256starstar.c
+ *
+ * Parameters:
+ *   - RandomState *rng: The generator to advance.
+ *
+ * Returns:
+ *   - uint64_t: A 64-bit random number.
+ */
+uint64_t nextRandom(RandomState *rng) {
+    uint64_t *s = rng->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+
+    return result;
+}
+
+/**
+ * Returns a uniform random number in [0, bound) without modulo bias,
+ * using a multiply and a rejection step only in the rare biased case (Lemire's method).
+ *
+ * Parameters:
+ *   - RandomState *rng: The generator to use.
+ *   - uint32_t bound: Upper limit (exclusive), must be greater than 0.
+ *
+ * Returns:
+ *   - uint32_t: A number between 0 and bound - 1.
+ */
+uint32_t randomBelow(RandomState *rng, uint32_t bound) {
+    uint64_t product = (nextRandom(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = (uint32_t)(-bound) % bound;
+        while (low < threshold) {
+            product = (nextRandom(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+/**
+ * Makes a seed from the wall clock and the processor time, for normal (not replayed) games.
+ *
+ * Returns:
+ *   - uint64_t: A seed that changes from one call to the next.
+ */
+uint64_t makeRandomSeed(void) {
+    static uint64_t counter = 0;
+    uint64_t seed = ((uint64_t)time(NULL) << 32) ^ (uint64_t)clock() ^ (++counter * 0x9E3779B97F4A7C15ULL);
+    return splitMix64(&seed);
+}
@@ -2,6 +2,8 @@
 #include "../include/button_func.h"
 #include "../include/screen_manager.h"
 #include "../include/sdl_init.h"
+#include "../include/digit_atlas.h"
+#include "../include/asset_cache.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
@@ -73,6 +75,11 @@ void ActiveHardMode(Screen *screen){
     gameMode = MODE_HARD;
 }
 
+void ToggleNoGuessMode(Screen *screen){
+    screen->checkBoxes[3].isChecked = !screen->checkBoxes[3].isChecked;
+    noGuessMode = screen->checkBoxes[3].isChecked;
+}
+
 void MusicON(Screen *screen){
     Mix_ResumeMusic();
     screen->checkBoxes[1].isChecked = 1;
@@ -90,23 +97,19 @@ void  toGameRepo(){
 }
 
 void openGame(){
+    // Board size and mines come from the presets shared with the engine tools (see engine.c)
+    gameRowsNum = modePresets[gameMode].rows;
+    gameColsNum = modePresets[gameMode].cols;
+    gameMinesNum = modePresets[gameMode].numMines;
+
     switch(gameMode){
     case MODE_EASY:
-        gameRowsNum = 9;
-        gameColsNum = 9;
-        gameMinesNum = 10;
         cellSize = 50;
         break;
     case MODE_MEDIUM:
-        gameRowsNum = 16;
-        gameColsNum = 16;
-        gameMinesNum = 40;
         cellSize = 40;
         break;
     case MODE_HARD:
-        gameRowsNum = 16;
-        gameColsNum = 30;
-        gameMinesNum = 99;
         cellSize = 30;
         break;
     }
@@ -162,7 +165,7 @@ Screen* createModeScreen() {
     Screen *modeScreen = (Screen*)malloc(sizeof(Screen));
     modeScreen->screenName = "MODE SCREEN";  // Set the screen name
     modeScreen->buttonCount = 4;  // 4 buttons for the mode screen options
-    modeScreen->checkBoxCount = 3;  // 3 checkboxes for the different difficulty modes
+    modeScreen->checkBoxCount = 4;  // 3 checkboxes for the different difficulty modes and 1 for no-guess boards
 
     // Define colors for text elements
     SDL_Color textColorGrey = { 70, 70, 70 };
@@ -171,7 +174,7 @@ Screen* createModeScreen() {
 
     // Allocate memory for the buttons and create them with respective labels and positions
     modeScreen->buttons = malloc(modeScreen->buttonCount * sizeof(Button));
-    modeScreen->buttons[0] = createButton("assets/Window.png", "", textColorGrey, 0, .5, .5, screenWidth - (screenWidth * 0.1), screenHeight - (screenHeight * 0.1));  // Window button
+    modeScreen->buttons[0] = createScaledButton("assets/Window.png", "", textColorGrey, 0, .5, .5, .9, .9);  // Window button
     modeScreen->buttons[1] = createButton("assets/buttons/default-button.png", "Play", textColorGrey, 0, .9, .9, 300, 75);  // Play button
     modeScreen->buttons[2] = createButton("assets/buttons/small_button.png", "", textColorRed, 0, .1, .1, 50, 50);  // Small button
     modeScreen->buttons[3] = createButton("assets/buttons/close_button.png", "", textColorRed, 0, .1, .1, 45, 45);  // Close button
@@ -184,14 +187,17 @@ Screen* createModeScreen() {
     modeScreen->checkBoxes[0] = createCheckbox("assets/buttons/Windows_Toggle_Active.png", "assets/buttons/Windows_Toggle_Selected.png", "Easy Mode (9x9 - 10 mines)", textColorWhite, 1, .2, .3, 40, 40);  // Easy Mode checkbox
     modeScreen->checkBoxes[1] = createCheckbox("assets/buttons/Windows_Toggle_Active.png", "assets/buttons/Windows_Toggle_Selected.png", "Medium Mode (16x16 - 40 mines)", textColorWhite, 1, .2, .5, 40, 40);  // Medium Mode checkbox
     modeScreen->checkBoxes[2] = createCheckbox("assets/buttons/Windows_Toggle_Active.png", "assets/buttons/Windows_Toggle_Selected.png", "Hard Mode (30x16 - 99 mines)", textColorWhite, 1, .2, .7, 40, 40);  // Hard Mode checkbox
+    modeScreen->checkBoxes[3] = createCheckbox("assets/buttons/Windows_Toggle_Active.png", "assets/buttons/Windows_Toggle_Selected.png", "No guessing", textColorWhite, 1, .2, .9, 40, 40);  // No-guess boards checkbox
 
     // Set the default checkbox for Easy Mode to be checked
     modeScreen->checkBoxes[0].isChecked = 1;
+    modeScreen->checkBoxes[3].isChecked = noGuessMode;  // Keep the choice when the screen is recreated
 
     // Assign the onClick event for each checkbox
     modeScreen->checkBoxes[0].onClick = ActiveEasyMode;
     modeScreen->checkBoxes[1].onClick = ActiveMediumMode;
     modeScreen->checkBoxes[2].onClick = ActiveHardMode;
+    modeScreen->checkBoxes[3].onClick = ToggleNoGuessMode;
 
     // Assign the onClick event for the Play button
     modeScreen->buttons[1].onClick = openGame;
@@ -218,7 +224,7 @@ Screen* createGameScreen() {
 
     // Allocate memory for the buttons and create them with respective labels and positions
     gameScreen->buttons = malloc(gameScreen->buttonCount * sizeof(Button));
-    gameScreen->buttons[0] = createButton("assets/Window.png", "", textColorGrey, 0, .5, .5, screenWidth, screenHeight);
+    gameScreen->buttons[0] = createScaledButton("assets/Window.png", "", textColorGrey, 0, .5, .5, 1, 1);
     gameScreen->buttons[1] = createButton("assets/buttons/small_button.png", " | | ", textColorGrey, 0, .02, .02, 75, 75);
 
     gameScreen->buttons[1].onClick = toMenuGameScreen ;
@@ -245,7 +251,7 @@ Screen* createGameOverScreen() {
 
      // Allocate memory for the buttons and create them with respective labels and positions
     gameOverScreen->buttons = malloc(gameOverScreen->buttonCount * sizeof(Button));
-    gameOverScreen->buttons[0] = createButton("assets/Window.png", "", textColorGrey, 0, .5, .5, screenWidth - (screenWidth * 0.5), screenHeight - (screenHeight * 0.2));
+    gameOverScreen->buttons[0] = createScaledButton("assets/Window.png", "", textColorGrey, 0, .5, .5, .5, .8);
     gameOverScreen->buttons[1] = createButton("assets/buttons/default-button.png", "Play Again", textColorGrey, 0, .5, .8, 300, 75);
     gameOverScreen->buttons[2] = createButton("assets/images/youwin.png", "", textColorGrey, 0, .5, .2, 300, 169);
 
@@ -267,7 +273,7 @@ Screen* createAchievementScreen(Achievement achievements[], int totalAchievement
 
     // Define buttons
     achievementsScreen->buttons = malloc(achievementsScreen->buttonCount * sizeof(Button));
-    achievementsScreen->buttons[0] = createButton("assets/Window.png", "", textColorWhite, 0, .5, .5, screenWidth - (screenWidth * 0.1), screenHeight - (screenHeight * 0.1));  // Window button
+    achievementsScreen->buttons[0] = createScaledButton("assets/Window.png", "", textColorWhite, 0, .5, .5, .9, .9);  // Window button
     achievementsScreen->buttons[1] = createButton("assets/buttons/small_button.png", "", textColorWhite, 0, .1, .1, 50, 50);  // Small button
     achievementsScreen->buttons[2] = createButton("assets/buttons/close_button.png", "", textColorWhite, 0, .1, .1, 45, 45);  // Close button
 
@@ -286,6 +292,22 @@ Screen* createAchievementScreen(Achievement achievements[], int totalAchievement
     return achievementsScreen;
 }
 
+/**
+ * Ticks the checkbox of an achievement that was just unlocked. The achievements screen is built once (and again
+ * on resize), and this keeps it up to date without rebuilding it: it is given to setAchievementUnlockedHandler
+ * with the address of the screen pointer, so it follows the screen when it is recreated.
+ *
+ * Parameters:
+ *   - void *achievementScreen: The address of the Screen* of the achievements screen.
+ *   - int index: The index of the unlocked achievement (the index of its checkbox).
+ */
+void markAchievementUnlocked(void *achievementScreen, int index) {
+    Screen *screen = *(Screen**)achievementScreen;
+    if (screen && index >= 0 && index < screen->checkBoxCount) {
+        screen->checkBoxes[index].isChecked = 1;
+    }
+}
+
 Screen* createSettingsScreen(Achievement achievements[], int totalAchievements){
     // Initialize the screen structure for the game screen
     Screen *SettingsScreen = (Screen*)malloc(sizeof(Screen));
@@ -300,7 +322,7 @@ Screen* createSettingsScreen(Achievement achievements[], int totalAchievements){
 
     // Define buttons
     SettingsScreen->buttons = malloc(SettingsScreen->buttonCount * sizeof(Button));
-    SettingsScreen->buttons[0] = createButton("assets/Window.png", "", textColorWhite, 0, .5, .5, screenWidth - (screenWidth * 0.1), screenHeight - (screenHeight * 0.1));  // Window button
+    SettingsScreen->buttons[0] = createScaledButton("assets/Window.png", "", textColorWhite, 0, .5, .5, .9, .9);  // Window button
     SettingsScreen->buttons[1] = createButton("assets/buttons/small_button.png", "", textColorWhite, 0, .1, .1, 50, 50);  // Small button
     SettingsScreen->buttons[2] = createButton("assets/buttons/close_button.png", "", textColorWhite, 0, .1, .1, 45, 45);  // Close button
     SettingsScreen->buttons[3] = createButton("assets/buttons/default-button.png", "Open Game Repository", textColorGrey, 0, .5, .9, 300, 75);
@@ -344,23 +366,73 @@ void renderScreen(Screen *Screen, SDL_Surface *screen) {
     }
 }
 
-void displayBestThreeTimes(SDL_Surface *screen) {
+/**
+ * Reads the three best times from time.dat. The game over screen reads them once when it opens,
+ * not on every frame. A player who never won has no time.dat yet, which isn't an error.
+ *
+ * Parameters:
+ *   - Uint32 times[3]: Receives the times, in seconds.
+ *
+ * Returns:
+ *   - int: 1 if the three times were read, 0 otherwise (no file, or a short one).
+ */
+int loadBestThreeTimes(Uint32 times[3]) {
     FILE *file = fopen("time.dat", "rb");
     if (!file) {
-        fprintf(stderr, "Error: Could not open time.dat\n");
-        gameState = GAME_OFF;
-        return;
+        return 0;  // No best times yet
     }
 
     // Read three Uint32 values from the binary file time.dat
-    Uint32 values[3];
-    if (fread(values, sizeof(Uint32), 3, file) != 3) {
+    if (fread(times, sizeof(Uint32), 3, file) != 3) {
         fprintf(stderr, "Error: Could not read three values from time.dat\n");
         fclose(file);
-        return;
+        return 0;
     }
     fclose(file);
+    return 1;
+}
+
+/**
+ * Places the buttons and checkboxes of a screen again after the window was resized, from their percentage
+ * anchors. Only the buttons that cover a share of the window get new images; the others are just moved.
+ *
+ * Parameters:
+ *   - Screen: A pointer to the screen to lay out.
+ */
+void layoutScreen(Screen *Screen) {
+    int i;
+    for (i = 0; i < Screen->buttonCount; i++) {
+        layoutButton(&(Screen->buttons[i]));
+    }
+    for (i = 0; i < Screen->checkBoxCount; i++) {
+        layoutCheckbox(&(Screen->checkBoxes[i]));
+    }
+}
 
+/**
+ * Tells if a screen has a button that covers the whole window with an opaque image (a full window panel),
+ * in which case nothing drawn under the screen can be seen.
+ *
+ * Parameters:
+ *   - Screen: A pointer to the screen to check.
+ *
+ * Returns:
+ *   - int: 1 if the screen hides the whole window, 0 otherwise.
+ */
+int coversWindow(Screen *Screen) {
+    int i;
+    for (i = 0; i < Screen->buttonCount; i++) {
+        Button *button = &(Screen->buttons[i]);
+        if (button->position.x <= 0 && button->position.y <= 0 &&
+            button->position.x + button->width >= screenWidth && button->position.y + button->height >= screenHeight &&
+            isImageOpaque(button->image)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void displayBestThreeTimes(SDL_Surface *screen, const Uint32 values[3]) {
     // Convert the values to strings (minutes:seconds format)
     char text1[20], text2[20], text3[20];
     sprintf(text1, "%02u:%02u", values[0] / 60, values[0] % 60); // Use %u for Uint32
@@ -368,34 +440,17 @@ void displayBestThreeTimes(SDL_Surface *screen) {
     sprintf(text3, "%02u:%02u", values[2] / 60, values[2] % 60);
 
     SDL_Color color = {255, 255, 255}; // White color for text
-    // Render the text to SDL_Surfaces
-    SDL_Surface *textSurface1 = TTF_RenderText_Solid(fonts[3], text1, color);
-    SDL_Surface *textSurface2 = TTF_RenderText_Solid(fonts[3], text2, color);
-    SDL_Surface *textSurface3 = TTF_RenderText_Solid(fonts[3], text3, color);
-
-    if (!textSurface1 || !textSurface2 || !textSurface3) {
-        fprintf(stderr, "Error: Could not render text surfaces\n");
-        gameState = GAME_OFF;
-        return;
-    }
+    DigitAtlas *atlas = &digitAtlases[3];  // Digits rendered once at startup
+    int height = atlas->glyphs[0].h;
 
     // Calculate positions to center the text
     int centerX = screen->w / 2;
     int centerY = screen->h / 2;
 
-    SDL_Rect pos1 = {centerX - textSurface1->w / 2, centerY - textSurface1->h - 10, 0, 0};
-    SDL_Rect pos2 = {centerX - textSurface2->w / 2, centerY, 0, 0};
-    SDL_Rect pos3 = {centerX - textSurface3->w / 2, centerY + textSurface2->h + 10, 0, 0};
-
-    // Blit the text to the screen
-    SDL_BlitSurface(textSurface1, NULL, screen, &pos1);
-    SDL_BlitSurface(textSurface2, NULL, screen, &pos2);
-    SDL_BlitSurface(textSurface3, NULL, screen, &pos3);
-
-    // Free the surfaces
-    SDL_FreeSurface(textSurface1);
-    SDL_FreeSurface(textSurface2);
-    SDL_FreeSurface(textSurface3);
+    // Draw the times with one blit per character
+    drawDigits(screen, atlas, text1, centerX - measureDigits(atlas, text1) / 2, centerY - height - 10, color);
+    drawDigits(screen, atlas, text2, centerX - measureDigits(atlas, text2) / 2, centerY, color);
+    drawDigits(screen, atlas, text3, centerX - measureDigits(atlas, text3) / 2, centerY + height + 10, color);
 }
 
 /**
@@ -0,0 +1,250 @@
+#include "../include/struct.h"
+#include "../include/screen_states.h"
+#include "../include/screen_manager.h"
+#include "../include/button_func.h"
+#include "../include/game_manager.h"
+#include "../include/dirty_rects.h"
+#include <SDL.h>
+
+// Cells the grid moves by for each press of an arrow key
+#define GAME_PAN_CELLS 4
+
+
+/*******************MENU SCREEN*************************/
+
+
+static void renderMenuScreen(ScreenContext *context) {
+    renderScreen(context->menuScreen, context->window);
+}
+
+static void clickMenuScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button != SDL_BUTTON_LEFT) return;
+
+    handleButtonClick(context->menuScreen, mouseX, mouseY);  // Main menu button click
+    if (currentScreen == 1 && context->game->field.gameState != 0) {  // if the player already lost the previous game don't open it
+        currentScreen = 0;
+    }
+}
+
+
+/*******************GAME SCREEN*************************/
+
+
+static void renderGameScreen(ScreenContext *context) {
+    renderScreen(context->gameScreen, context->window);
+    drawGrid(context->window, context->game);
+}
+
+/**
+ * The game screen only changes where cells were revealed or flagged and in the timer, so once it has been drawn
+ * in full its frames redraw and push just those areas (the background stays still behind it).
+ */
+static void updateGameScreen(ScreenContext *context) {
+    drawGridChanges(context->window, context->game);
+}
+
+static void clickGameScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button == SDL_BUTTON_LEFT) {  // Game screen cell clicks
+        handleCellClick(context->game, mouseX, mouseY, context->playerStats);
+        handleButtonClick(context->gameScreen, mouseX, mouseY);
+    } else if (button == SDL_BUTTON_RIGHT) {  // Game screen flags click
+        handleFlagClick(context->game, mouseX, mouseY);
+    } else if (button == SDL_BUTTON_WHEELUP || button == SDL_BUTTON_WHEELDOWN) {  // Zoom around the mouse
+        if (zoomGameView(context->game, button == SDL_BUTTON_WHEELUP ? 1 : -1, mouseX, mouseY)) {
+            markFullRedraw(&dirtyRects);
+        }
+    }
+}
+
+// Dragging with the middle button pans the grid
+static void moveGameScreen(ScreenContext *context, int moveX, int moveY, Uint8 buttons) {
+    if ((buttons & SDL_BUTTON(SDL_BUTTON_MIDDLE)) && panGameView(context->game, -moveX, -moveY)) {
+        markFullRedraw(&dirtyRects);
+    }
+}
+
+// The arrow keys pan the grid by a few cells, + and - zoom around the centre of the view
+static void keyGameScreen(ScreenContext *context, SDLKey key) {
+    Viewport *view = &context->game->view;
+    int step = GAME_PAN_CELLS * view->cellSize;
+    int centreX = view->area.x + view->area.w / 2, centreY = view->area.y + view->area.h / 2;
+    int changed = 0;
+
+    switch (key) {
+        case SDLK_LEFT: changed = panGameView(context->game, -step, 0); break;
+        case SDLK_RIGHT: changed = panGameView(context->game, step, 0); break;
+        case SDLK_UP: changed = panGameView(context->game, 0, -step); break;
+        case SDLK_DOWN: changed = panGameView(context->game, 0, step); break;
+        case SDLK_PLUS:
+        case SDLK_EQUALS:
+        case SDLK_KP_PLUS: changed = zoomGameView(context->game, 1, centreX, centreY); break;
+        case SDLK_MINUS:
+        case SDLK_KP_MINUS: changed = zoomGameView(context->game, -1, centreX, centreY); break;
+        default: break;
+    }
+    if (changed) {
+        markFullRedraw(&dirtyRects);
+    }
+}
+
+
+/*******************MODE SCREEN*************************/
+
+
+static void renderModeScreen(ScreenContext *context) {
+    renderScreen(context->modeScreen, context->window);
+}
+
+static void clickModeScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button != SDL_BUTTON_LEFT) return;
+
+    if (handleButtonClick(context->modeScreen, mouseX, mouseY)) {
+        if (currentScreen == 4) {
+            initializeGame(context->game);  // Initialize the game when play button is clicked
+        }
+    }
+    handleCheckBoxClick(context->modeScreen, mouseX, mouseY);  // Handle checkbox clicks (game modes)
+}
+
+
+/*******************ACHIEVEMENTS SCREEN*************************/
+
+
+// The checkboxes are ticked as the achievements unlock (see markAchievementUnlocked)
+static void renderAchievementScreen(ScreenContext *context) {
+    renderScreen(context->achievementScreen, context->window);
+}
+
+static void clickAchievementScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button == SDL_BUTTON_LEFT) {
+        handleButtonClick(context->achievementScreen, mouseX, mouseY);
+    }
+}
+
+
+/*******************GAME OVER SCREEN*************************/
+
+
+/**
+ * Sets up the game over screen once per game: the win or lose banner, the best times (read from time.dat)
+ * and the achievements the game unlocked.
+ */
+static void enterGameOverScreen(ScreenContext *context) {
+    SDL_Color textColorGrey = { 70, 70, 70 };
+    const char *banner = context->game->field.gameState == 1 ? "assets/images/youlose.png" : "assets/images/youwin.png";
+    Button bannerButton = createButton(banner, "", textColorGrey, 0, .5, .2, 300, 169);
+    freeButton(&context->gameOverScreen->buttons[2]);  // Released after the new one took its image, so it stays cached
+    context->gameOverScreen->buttons[2] = bannerButton;
+
+    context->bestTimesLoaded = context->skipBestTimes ? 0 : loadBestThreeTimes(context->bestTimes);
+    checkAchievements(context->achievements, *context->playerStats, *context->game);
+}
+
+static void exitGameOverScreen(ScreenContext *context) {
+    context->bestTimesLoaded = 0;  // The next game may change them
+}
+
+static void renderGameOverScreen(ScreenContext *context) {
+    renderScreen(context->gameOverScreen, context->window);
+    if (context->bestTimesLoaded) {
+        displayBestThreeTimes(context->window, context->bestTimes);
+    }
+}
+
+static void clickGameOverScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button == SDL_BUTTON_LEFT) {
+        handleButtonClick(context->gameOverScreen, mouseX, mouseY);  // game over button click
+    }
+}
+
+
+/*******************SETTINGS SCREEN*************************/
+
+
+static void renderSettingsScreen(ScreenContext *context) {
+    renderScreen(context->settingsScreen, context->window);
+}
+
+static void clickSettingsScreen(ScreenContext *context, int mouseX, int mouseY, int button) {
+    if (button == SDL_BUTTON_LEFT) {
+        handleButtonClick(context->settingsScreen, mouseX, mouseY);
+        handleCheckBoxClick(context->settingsScreen, mouseX, mouseY);
+    }
+}
+
+
+/*******************STATE MACHINE*************************/
+
+
+const ScreenState screenStates[NUM_SCREENS] = {
+    {"MENU SCREEN", 1, NULL, NULL, NULL, renderMenuScreen, clickMenuScreen, NULL, NULL},
+    {"GAME SCREEN", 0, NULL, NULL, updateGameScreen, renderGameScreen, clickGameScreen, moveGameScreen, keyGameScreen},  // Continued game
+    {"MODE SCREEN", 1, NULL, NULL, NULL, renderModeScreen, clickModeScreen, NULL, NULL},
+    {"ACHIEVEMENTS SCREEN", 1, NULL, NULL, NULL, renderAchievementScreen, clickAchievementScreen, NULL, NULL},
+    {"GAME SCREEN", 0, NULL, NULL, updateGameScreen, renderGameScreen, clickGameScreen, moveGameScreen, keyGameScreen},  // New game
+    {"GAME OVER SCREEN", 1, enterGameOverScreen, exitGameOverScreen, NULL, renderGameOverScreen, clickGameOverScreen, NULL, NULL},
+    {"SETTINGS SCREEN", 1, NULL, NULL, NULL, renderSettingsScreen, clickSettingsScreen, NULL, NULL}
+};
+
+/**
+ * Tells if a screen is drawn over the whole window with an opaque panel, so the background under it
+ * doesn't need to be drawn.
+ *
+ * Parameters:
+ *   - ScreenContext *context: The state the screens work on.
+ *   - int screen: The screen index.
+ *
+ * Returns:
+ *   - int: 1 if the background can be skipped, 0 otherwise.
+ */
+int hidesBackground(ScreenContext *context, int screen) {
+    switch (screen) {
+        case 0: return coversWindow(context->menuScreen);
+        case 1:
+        case 4: return coversWindow(context->gameScreen);
+        case 2: return coversWindow(context->modeScreen);
+        case 3: return coversWindow(context->achievementScreen);
+        case 5: return coversWindow(context->gameOverScreen);
+        case 6: return coversWindow(context->settingsScreen);
+    }
+    return 0;
+}
+
+/**
+ * Leaves a screen and enters another one, and asks for the whole window to be redrawn. Switching from a screen
+ * to itself runs its onExit and onEnter again (after a resize recreated the screens).
+ *
+ * Parameters:
+ *   - ScreenContext *context: The state the screens work on.
+ *   - int from: The screen to leave (less than 0 if none was active yet).
+ *   - int to: The screen to enter.
+ */
+void switchScreen(ScreenContext *context, int from, int to) {
+    if (from >= 0 && screenStates[from].onExit) {
+        screenStates[from].onExit(context);
+    }
+    if (screenStates[to].onEnter) {
+        screenStates[to].onEnter(context);
+    }
+    markFullRedraw(&dirtyRects);
+}
+
+/**
+ * Switches to the screen asked for in currentScreen by the button callbacks, if it isn't the active one.
+ * Entering a screen may ask for yet another one, which is followed as well.
+ *
+ * Parameters:
+ *   - ScreenContext *context: The state the screens work on.
+ *   - int activeScreen: The screen that is active.
+ *
+ * Returns:
+ *   - int: The screen that is active now.
+ */
+int applyScreenChange(ScreenContext *context, int activeScreen) {
+    while (currentScreen != activeScreen) {
+        int next = currentScreen;
+        switchScreen(context, activeScreen, next);
+        activeScreen = next;
+    }
+    return activeScreen;
+}
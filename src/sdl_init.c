@@ -1,9 +1,11 @@
 #include "../include/sdl_init.h"
 #include "../include/struct.h"
+#include "../include/digit_atlas.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
+#include <stdlib.h>
 
 /**
  * Initializes SDL and sets up the window for the game.
@@ -60,6 +62,39 @@ void initialize_sdl(SDL_Surface **window) {
     SDL_WM_SetCaption("Minesweeper-1.0", NULL);
 }
 
+/**
+ * Initializes SDL without a visible window, for the tools that render the screens on a machine without a display
+ * (see bench/screen_harness.c). SDL's dummy video driver is used unless SDL_VIDEODRIVER already names one, so the
+ * window surface is a plain software surface of screenWidth x screenHeight in 32 bits, like the game window.
+ * Audio isn't opened and stdout and stderr are left where they are.
+ *
+ * Parameters:
+ *   - window: A pointer to an SDL_Surface pointer, which will hold the reference to the window surface.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if SDL or the video mode couldn't be initialized (gameState is set to GAME_OFF).
+ */
+int initializeHeadlessSdl(SDL_Surface **window) {
+    if (!getenv("SDL_VIDEODRIVER")) {
+        SDL_putenv("SDL_VIDEODRIVER=dummy");
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "Unable to initialize SDL: %s\n", SDL_GetError());
+        gameState = GAME_OFF;
+        return 0;
+    }
+
+    *window = SDL_SetVideoMode(screenWidth, screenHeight, 32, SDL_SWSURFACE);
+    if (!(*window)) {
+        fprintf(stderr, "Unable to set video mode: %s\n", SDL_GetError());
+        SDL_Quit();
+        gameState = GAME_OFF;
+        return 0;
+    }
+    return 1;
+}
+
 /**
  * Handles resizing the SDL window when the user resizes the window.
  * The screen width and height are updated to the new dimensions provided by the `SDL_Event` resize event.
@@ -89,6 +124,7 @@ void resize_window(SDL_Surface **window, SDL_Event event) {
 /**
  * Initializes the fonts for the game by loading font files at various sizes.
  * This function uses the `TTF_OpenFont` function to open the font file at different sizes specified in the `fontSizes` array.
+ * The digits and ':' of every size are also rendered once into a digit atlas (see digit_atlas.c).
  * If any font fails to load, it will clean up previously loaded fonts and stop the initialization process.
  *
  * @param fontPath The path to the font file that should be used for the game.
@@ -115,6 +151,9 @@ void initializeFonts(const char *fontPath) {
             cleanupFonts();  // Clean up any previously loaded fonts
             return;
         }
+
+        // Render the digits of this size once for the timer and the best times
+        buildDigitAtlas(&digitAtlases[i], fonts[i]);
     }
 }
 
@@ -136,5 +175,6 @@ void cleanupFonts() {
             TTF_CloseFont(fonts[i]);
             fonts[i] = NULL;  // Set the pointer to NULL to avoid dangling pointer issues
         }
+        freeDigitAtlas(&digitAtlases[i]);  // Free the digits rendered with this font
     }
 }
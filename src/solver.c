@@ -0,0 +1,911 @@
+#include "../include/solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Fields of one entry of componentInfo
+#define COMPONENT_START 0
+#define COMPONENT_SIZE 1
+#define COMPONENT_COUNTS 2
+#define COMPONENT_LIMIT 3
+#define COMPONENT_FIELDS 4
+
+// frontierId of a covered cell that touches a constraint but hasn't been put in a component yet
+#define FRONTIER_PENDING -2
+
+/**
+ * Allocates the per cell arrays of a solver for boards of the given size.
+ * The count buffers start empty and grow the first time a large component needs them.
+ *
+ * Parameters:
+ *   - Solver *solver: The solver to initialize.
+ *   - int rows: Number of rows of the boards to solve.
+ *   - int cols: Number of columns of the boards to solve.
+ *
+ * Returns:
+ *   - int: 1 if the solver was allocated, 0 if the allocation failed.
+ */
+int initSolver(Solver *solver, int rows, int cols) {
+    memset(solver, 0, sizeof(Solver));
+    solver->rows = rows > 0 ? rows : 0;
+    solver->cols = cols > 0 ? cols : 0;
+    solver->exact = 1;
+
+    size_t cells = (size_t)solver->rows * solver->cols + 1;
+    solver->probability = malloc(cells * sizeof(double));
+    solver->state = malloc(cells);
+    solver->cellConstraint = malloc(cells * sizeof(int));
+    solver->frontierId = malloc(cells * sizeof(int));
+    solver->queue = malloc(cells * sizeof(int));
+    solver->frontier = malloc(cells * sizeof(int));
+    solver->componentInfo = malloc(cells * COMPONENT_FIELDS * sizeof(int));
+    solver->constraintNeed = malloc(cells * sizeof(int));
+    solver->constraintLeft = malloc(cells * sizeof(int));
+    solver->constraintFirst = malloc(cells * sizeof(int));
+    solver->constraintLast = malloc(cells * sizeof(int));
+    solver->constraintWork = malloc(cells * sizeof(int));
+    solver->open = malloc(cells * sizeof(int));
+    solver->nextOpen = malloc(cells * sizeof(int));
+    solver->boundaryStart = malloc((cells + 1) * sizeof(int));
+
+    if (!solver->probability || !solver->state || !solver->cellConstraint || !solver->frontierId || !solver->queue ||
+        !solver->frontier || !solver->componentInfo || !solver->constraintNeed || !solver->constraintLeft ||
+        !solver->constraintFirst || !solver->constraintLast || !solver->constraintWork || !solver->open ||
+        !solver->nextOpen || !solver->boundaryStart) {
+        freeSolver(solver);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Frees every array of the solver and resets its pointers.
+ *
+ * Parameters:
+ *   - Solver *solver: The solver to free.
+ */
+void freeSolver(Solver *solver) {
+    free(solver->probability);
+    free(solver->state);
+    free(solver->cellConstraint);
+    free(solver->frontierId);
+    free(solver->queue);
+    free(solver->frontier);
+    free(solver->componentInfo);
+    free(solver->constraintNeed);
+    free(solver->constraintLeft);
+    free(solver->constraintFirst);
+    free(solver->constraintLast);
+    free(solver->constraintWork);
+    free(solver->open);
+    free(solver->nextOpen);
+    free(solver->boundaryStart);
+    free(solver->stateKeys);
+    free(solver->stateNext);
+    free(solver->transitions);
+    free(solver->paths);
+    free(solver->counts);
+    free(solver->mixes);
+    memset(solver, 0, sizeof(Solver));
+}
+
+/**
+ * Makes sure a buffer of doubles holds at least `count` entries, keeping its content.
+ *
+ * Returns:
+ *   - int: 1 if the buffer is large enough, 0 if it could not grow.
+ */
+static int reserveDoubles(double **buffer, int *capacity, long count) {
+    if (count <= *capacity) {
+        return 1;
+    }
+    long grown = *capacity ? *capacity : 1024;
+    while (grown < count) {
+        grown *= 2;
+    }
+    double *resized = realloc(*buffer, grown * sizeof(double));
+    if (!resized) {
+        return 0;
+    }
+    *buffer = resized;
+    *capacity = (int)grown;
+    return 1;
+}
+
+/**
+ * Counts the unknown neighbours and the known mines around a revealed cell.
+ */
+static void countNeighbours(const Solver *solver, int row, int col, int *unknown, int *mines) {
+    int i, j;
+    *unknown = 0;
+    *mines = 0;
+    for (i = row - 1; i <= row + 1; i++) {
+        if (i < 0 || i >= solver->rows) continue;
+        for (j = col - 1; j <= col + 1; j++) {
+            if (j < 0 || j >= solver->cols) continue;
+            uint8_t state = solver->state[i * solver->cols + j];
+            *unknown += state == SOLVER_UNKNOWN;
+            *mines += state == SOLVER_MINE;
+        }
+    }
+}
+
+/**
+ * Pushes the revealed numbers around a cell on the work list of the trivial rules.
+ * cellConstraint is used as the "already on the list" mark while the rules run.
+ */
+static void queueNumbersAround(Solver *solver, const Board *board, int row, int col, int *count) {
+    int i, j;
+    for (i = row - 1; i <= row + 1; i++) {
+        if (i < 0 || i >= solver->rows) continue;
+        for (j = col - 1; j <= col + 1; j++) {
+            if (j < 0 || j >= solver->cols) continue;
+            int index = i * solver->cols + j;
+            if (solver->state[index] == SOLVER_REVEALED && solver->cellConstraint[index] == -1 && getAdjacentMines(board, i, j) > 0) {
+                solver->cellConstraint[index] = 1;
+                solver->queue[(*count)++] = index;
+            }
+        }
+    }
+}
+
+/**
+ * Applies the two trivial rules until they find nothing new: a number whose unknown neighbours are exactly
+ * its missing mines makes them all mines, and a number whose mines are all known makes the rest safe.
+ * Only the numbers around a cell that just got a state are looked at again.
+ */
+static void applyTrivialRules(Solver *solver, const Board *board) {
+    int cells = solver->rows * solver->cols;
+    int index, count = 0;
+
+    for (index = 0; index < cells; index++) {
+        if (solver->state[index] == SOLVER_REVEALED && getAdjacentMines(board, index / solver->cols, index % solver->cols) > 0) {
+            solver->cellConstraint[index] = 1;
+            solver->queue[count++] = index;
+        }
+    }
+
+    while (count > 0) {
+        index = solver->queue[--count];
+        solver->cellConstraint[index] = -1;
+        int row = index / solver->cols;
+        int col = index % solver->cols;
+        int unknown, mines, i, j;
+        countNeighbours(solver, row, col, &unknown, &mines);
+        if (unknown == 0) continue;
+
+        int missing = getAdjacentMines(board, row, col) - mines;
+        uint8_t deduced;
+        if (missing == unknown) {
+            deduced = SOLVER_MINE;
+        } else if (missing == 0) {
+            deduced = SOLVER_SAFE;
+        } else {
+            continue;
+        }
+
+        for (i = row - 1; i <= row + 1; i++) {
+            if (i < 0 || i >= solver->rows) continue;
+            for (j = col - 1; j <= col + 1; j++) {
+                if (j < 0 || j >= solver->cols || solver->state[i * solver->cols + j] != SOLVER_UNKNOWN) continue;
+                solver->state[i * solver->cols + j] = deduced;
+                if (deduced == SOLVER_MINE) {
+                    solver->knownMines++;
+                }
+                queueNumbersAround(solver, board, i, j, &count);
+            }
+        }
+    }
+}
+
+/**
+ * Turns every revealed number that still touches unknown cells into a constraint
+ * (mines still needed, unknown cells around it) and marks those unknown cells as frontier cells.
+ *
+ * Returns:
+ *   - int: The number of frontier cells (their indexes are in solver->queue).
+ */
+static int buildConstraints(Solver *solver, const Board *board) {
+    int cells = solver->rows * solver->cols;
+    int index, constraints = 0, frontierCount = 0;
+
+    for (index = 0; index < cells; index++) {
+        int row = index / solver->cols;
+        int col = index % solver->cols;
+        int number = solver->state[index] == SOLVER_REVEALED ? getAdjacentMines(board, row, col) : 0;
+        if (number == 0) continue;
+
+        int unknown, mines, i, j;
+        countNeighbours(solver, row, col, &unknown, &mines);
+        if (unknown == 0) continue;
+
+        solver->cellConstraint[index] = constraints;
+        solver->constraintNeed[constraints] = number - mines;
+        solver->constraintLeft[constraints] = unknown;
+        solver->constraintFirst[constraints] = -1;
+        solver->constraintLast[constraints] = -1;
+        constraints++;
+
+        for (i = row - 1; i <= row + 1; i++) {
+            if (i < 0 || i >= solver->rows) continue;
+            for (j = col - 1; j <= col + 1; j++) {
+                if (j < 0 || j >= solver->cols) continue;
+                int neighbour = i * solver->cols + j;
+                if (solver->state[neighbour] == SOLVER_UNKNOWN && solver->frontierId[neighbour] == -1) {
+                    solver->frontierId[neighbour] = FRONTIER_PENDING;
+                    solver->queue[frontierCount++] = neighbour;
+                }
+            }
+        }
+    }
+    return frontierCount;
+}
+
+/**
+ * Checks if two frontier cells share a constraint (a revealed number adjacent to both).
+ */
+static int shareConstraint(const Solver *solver, int first, int second) {
+    int row = first / solver->cols, col = first % solver->cols;
+    int i = second / solver->cols, j = second % solver->cols;
+    int r, c;
+    for (r = (i > row ? i : row) - 1; r <= (i < row ? i : row) + 1; r++) {
+        if (r < 0 || r >= solver->rows) continue;
+        for (c = (j > col ? j : col) - 1; c <= (j < col ? j : col) + 1; c++) {
+            if (c >= 0 && c < solver->cols && solver->cellConstraint[r * solver->cols + c] >= 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Breadth-first search over the pending frontier cells linked to `seed`, appending them to solver->frontier.
+ * Cells two steps away can share one of the numbers around a cell, so the search looks at the 5x5 block.
+ *
+ * Returns:
+ *   - int: The new number of cells in solver->frontier.
+ */
+static int collectComponent(Solver *solver, int seed, int placed) {
+    int next = placed;
+    solver->frontierId[seed] = placed;
+    solver->frontier[placed++] = seed;
+
+    for (; next < placed; next++) {
+        int cell = solver->frontier[next];
+        int row = cell / solver->cols;
+        int col = cell % solver->cols;
+        int i, j;
+        for (i = row - 2; i <= row + 2; i++) {
+            if (i < 0 || i >= solver->rows) continue;
+            for (j = col - 2; j <= col + 2; j++) {
+                if (j < 0 || j >= solver->cols) continue;
+                int other = i * solver->cols + j;
+                if (solver->frontierId[other] == FRONTIER_PENDING && shareConstraint(solver, cell, other)) {
+                    solver->frontierId[other] = placed;
+                    solver->frontier[placed++] = other;
+                }
+            }
+        }
+    }
+    return placed;
+}
+
+/**
+ * Groups the frontier cells into components: two cells are in the same component when a chain of constraints
+ * links them. Each component is laid out in breadth-first order from one of its ends (the last cell reached by a
+ * first search), so a frontier that runs along a line is counted with few constraints open at a time.
+ *
+ * Returns:
+ *   - int: The number of components.
+ */
+static int groupComponents(Solver *solver, int frontierCount) {
+    int components = 0, placed = 0, f, d;
+
+    for (f = 0; f < frontierCount; f++) {
+        int seed = solver->queue[f];
+        if (solver->frontierId[seed] != FRONTIER_PENDING) continue;
+
+        int start = placed;
+        placed = collectComponent(solver, seed, start);
+
+        // Search again from the far end of the component
+        int end = solver->frontier[placed - 1];
+        for (d = start; d < placed; d++) {
+            solver->frontierId[solver->frontier[d]] = FRONTIER_PENDING;
+        }
+        collectComponent(solver, end, start);
+
+        int *info = &solver->componentInfo[components * COMPONENT_FIELDS];
+        info[COMPONENT_START] = start;
+        info[COMPONENT_SIZE] = placed - start;
+        components++;
+    }
+    return components;
+}
+
+/**
+ * Lists the constraints around a cell.
+ *
+ * Returns:
+ *   - int: The number of constraints (at most 8).
+ */
+static int cellConstraints(const Solver *solver, int cell, int *around) {
+    int row = cell / solver->cols;
+    int col = cell % solver->cols;
+    int i, j, count = 0;
+    for (i = row - 1; i <= row + 1; i++) {
+        if (i < 0 || i >= solver->rows) continue;
+        for (j = col - 1; j <= col + 1; j++) {
+            if (j >= 0 && j < solver->cols && solver->cellConstraint[i * solver->cols + j] >= 0) {
+                around[count++] = solver->cellConstraint[i * solver->cols + j];
+            }
+        }
+    }
+    return count;
+}
+
+static int compareTransitions(const void *a, const void *b) {
+    uint64_t x = ((const SolverTransition *)a)->key, y = ((const SolverTransition *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Makes sure the state arrays hold `count` states and the forward counts `count` rows.
+ */
+static int reserveStates(Solver *solver, int count, int stride) {
+    if (count > solver->stateCapacity) {
+        int capacity = solver->stateCapacity ? solver->stateCapacity : 256;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        uint64_t *keys = realloc(solver->stateKeys, capacity * sizeof(uint64_t));
+        if (keys) {
+            solver->stateKeys = keys;
+        }
+        int *next = realloc(solver->stateNext, 2 * capacity * sizeof(int));
+        if (next) {
+            solver->stateNext = next;
+        }
+        if (!keys || !next) {
+            return 0;
+        }
+        solver->stateCapacity = capacity;
+    }
+    return reserveDoubles(&solver->paths, &solver->pathsCapacity, (long)count * stride);
+}
+
+/**
+ * Counts the solutions of one component by dynamic programming over its cells in layout order, instead of
+ * trying every assignment. Between cell d - 1 and cell d (boundary d) the only thing that matters for the rest
+ * of the cells is how many mines each "open" constraint (with cells on both sides) still needs, so the
+ * assignments of the first d cells are merged by that vector of needs, packed 4 bits per constraint into a key.
+ * The forward pass counts the ways to reach every state with k mines so far, the backward pass the ways to
+ * finish from it with k more mines, and a cell's mine count for a total is the sum over the states before it
+ * of forward x backward through its mine transition.
+ *
+ * Parameters:
+ *   - Solver *solver: The solver, with the constraints built and the component laid out in solver->frontier.
+ *   - const int *info: The componentInfo entry of the component.
+ *   - int limit: Highest number of mines counted (the rest of the solutions are dropped).
+ *   - double *solutions: Receives the number of solutions for each mine total (limit + 1 entries).
+ *   - double *cellMines: Receives, for every cell d, the number of solutions with a mine on it for each mine total.
+ *
+ * Returns:
+ *   - int: 1 if the component was counted, 0 if memory could not be allocated,
+ *          -1 if it goes over the state budget or has no solution.
+ */
+static int countComponent(Solver *solver, const int *info, int limit, double *solutions, double *cellMines) {
+    const int *cells = solver->frontier + info[COMPONENT_START];
+    int size = info[COMPONENT_SIZE];
+    int stride = limit + 1;
+    int *open = solver->open, *nextOpen = solver->nextOpen;
+    int around[8], count, openCount = 0, d, i, k, s, t;
+
+    // Position of the first and last cell of every constraint of the component
+    for (d = 0; d < size; d++) {
+        count = cellConstraints(solver, cells[d], around);
+        for (i = 0; i < count; i++) {
+            if (solver->constraintFirst[around[i]] < 0) {
+                solver->constraintFirst[around[i]] = d;
+            }
+            solver->constraintLast[around[i]] = d;
+        }
+    }
+
+    // Boundary 0: one state, no constraint open, no mine yet
+    if (!reserveStates(solver, 1, stride)) {
+        return 0;
+    }
+    solver->boundaryStart[0] = 0;
+    solver->stateKeys[0] = 0;
+    memset(solver->paths, 0, stride * sizeof(double));
+    solver->paths[0] = 1;
+    int states = 1;
+
+    for (d = 0; d < size; d++) {
+        count = cellConstraints(solver, cells[d], around);
+
+        // Constraints open after this cell: the open ones that don't end here, then the ones this cell opens
+        int nextCount = 0;
+        for (i = 0; i < openCount; i++) {
+            if (solver->constraintLast[open[i]] > d) {
+                nextOpen[nextCount++] = open[i];
+            }
+        }
+        for (i = 0; i < count; i++) {
+            if (solver->constraintFirst[around[i]] == d && solver->constraintLast[around[i]] > d) {
+                nextOpen[nextCount++] = around[i];
+            }
+        }
+        if (nextCount > 16) {
+            return -1;  // The needs no longer fit in a 64-bit key
+        }
+
+        int begin = solver->boundaryStart[d];
+        if (2 * (states - begin) > solver->transitionCapacity) {
+            int capacity = 2 * (states - begin) * 2;
+            SolverTransition *transitions = realloc(solver->transitions, capacity * sizeof(SolverTransition));
+            if (!transitions) {
+                return 0;
+            }
+            solver->transitions = transitions;
+            solver->transitionCapacity = capacity;
+        }
+
+        // Try both values of the cell from every state
+        int transitionCount = 0;
+        for (s = begin; s < states; s++) {
+            uint64_t key = solver->stateKeys[s];
+            for (i = 0; i < openCount; i++) {
+                solver->constraintWork[open[i]] = (int)((key >> (4 * i)) & 15);
+            }
+            for (i = 0; i < count; i++) {
+                if (solver->constraintFirst[around[i]] == d) {
+                    solver->constraintWork[around[i]] = solver->constraintNeed[around[i]];
+                }
+            }
+
+            int mine;
+            for (mine = 0; mine <= 1; mine++) {
+                solver->stateNext[2 * s + mine] = -1;
+                for (i = 0; i < count; i++) {
+                    int need = solver->constraintWork[around[i]] - mine;
+                    if (need < 0 || need > solver->constraintLeft[around[i]] - 1) break;
+                }
+                if (i < count) continue;
+
+                uint64_t nextKey = 0;
+                for (i = 0; i < count; i++) {
+                    solver->constraintWork[around[i]] -= mine;
+                }
+                for (i = 0; i < nextCount; i++) {
+                    nextKey |= (uint64_t)solver->constraintWork[nextOpen[i]] << (4 * i);
+                }
+                for (i = 0; i < count; i++) {
+                    solver->constraintWork[around[i]] += mine;
+                }
+
+                SolverTransition *transition = &solver->transitions[transitionCount++];
+                transition->key = nextKey;
+                transition->from = s;
+                transition->mine = mine;
+            }
+        }
+        for (i = 0; i < count; i++) {
+            solver->constraintLeft[around[i]]--;
+        }
+        if (transitionCount == 0) {
+            return -1;  // No assignment satisfies the numbers
+        }
+
+        // Merge the transitions with the same needs into the states of the next boundary
+        qsort(solver->transitions, transitionCount, sizeof(SolverTransition), compareTransitions);
+        solver->boundaryStart[d + 1] = states;
+        int next = states;
+        for (t = 0; t < transitionCount; t++) {
+            const SolverTransition *transition = &solver->transitions[t];
+            if (t == 0 || transition->key != solver->transitions[t - 1].key) {
+                if ((long)(next + 1) * stride > SOLVER_STATE_BUDGET) {
+                    return -1;
+                }
+                if (!reserveStates(solver, next + 1, stride)) {
+                    return 0;
+                }
+                solver->stateKeys[next] = transition->key;
+                memset(solver->paths + (long)next * stride, 0, stride * sizeof(double));
+                next++;
+            }
+
+            double *from = solver->paths + (long)transition->from * stride;
+            double *to = solver->paths + (long)(next - 1) * stride;
+            solver->stateNext[2 * transition->from + transition->mine] = next - 1;
+            for (k = 0; k + transition->mine <= limit; k++) {
+                to[k + transition->mine] += from[k];
+            }
+        }
+        states = next;
+
+        int *swap = open;
+        open = nextOpen;
+        nextOpen = swap;
+        openCount = nextCount;
+    }
+    solver->states += states;
+
+    // Backward pass: the ways to finish from every state, filled from the last boundary (a single empty state)
+    if (!reserveDoubles(&solver->paths, &solver->pathsCapacity, 2L * states * stride)) {
+        return 0;
+    }
+    double *forward = solver->paths;
+    double *backward = solver->paths + (long)states * stride;
+    memset(backward, 0, (long)states * stride * sizeof(double));
+    memset(cellMines, 0, (long)size * stride * sizeof(double));
+    backward[(long)solver->boundaryStart[size] * stride] = 1;
+
+    for (d = size - 1; d >= 0; d--) {
+        for (s = solver->boundaryStart[d]; s < solver->boundaryStart[d + 1]; s++) {
+            double *ways = backward + (long)s * stride;
+            int safeNext = solver->stateNext[2 * s];
+            int mineNext = solver->stateNext[2 * s + 1];
+
+            if (safeNext >= 0) {
+                const double *after = backward + (long)safeNext * stride;
+                for (k = 0; k <= limit; k++) {
+                    ways[k] += after[k];
+                }
+            }
+            if (mineNext >= 0) {
+                const double *after = backward + (long)mineNext * stride;
+                const double *before = forward + (long)s * stride;
+                for (k = 1; k <= limit; k++) {
+                    ways[k] += after[k - 1];
+                }
+
+                // Solutions through this state with a mine on cell d
+                int k1, k2;
+                for (k1 = 0; k1 < limit; k1++) {
+                    if (before[k1] == 0) continue;
+                    for (k2 = 0; k1 + 1 + k2 <= limit; k2++) {
+                        cellMines[(long)d * stride + k1 + 1 + k2] += before[k1] * after[k2];
+                    }
+                }
+            }
+        }
+    }
+
+    memcpy(solutions, backward, stride * sizeof(double));
+    return 1;
+}
+
+/**
+ * Counts every component and stores its counts in solver->counts, scaled so the largest solution count is 1
+ * (the scale cancels out in the probabilities). A component that goes over the state budget gets a mine limit
+ * of -1 and its cells are treated as unconstrained.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if memory could not be allocated.
+ */
+static int countComponents(Solver *solver, int components, int minesLeft) {
+    long offset = 0;
+    int c, k, d;
+
+    for (c = 0; c < components; c++) {
+        int *info = &solver->componentInfo[c * COMPONENT_FIELDS];
+        int size = info[COMPONENT_SIZE];
+        int limit = size < minesLeft ? size : minesLeft;
+        if (limit < 0) {
+            // More mines proven than the board holds: the board is inconsistent
+            solver->exact = 0;
+            info[COMPONENT_LIMIT] = -1;
+            continue;
+        }
+        long entries = (long)(size + 1) * (limit + 1);
+        if (!reserveDoubles(&solver->counts, &solver->countsCapacity, offset + entries)) {
+            return 0;
+        }
+
+        double *solutions = solver->counts + offset;
+        double *cellMines = solutions + limit + 1;
+        int counted = countComponent(solver, info, limit, solutions, cellMines);
+        if (counted == 0) {
+            return 0;
+        }
+
+        double largest = 0;
+        for (k = 0; counted > 0 && k <= limit; k++) {
+            if (solutions[k] > largest) {
+                largest = solutions[k];
+            }
+        }
+        if (largest == 0) {
+            // Over budget (or no solution at all on an inconsistent board): leave the cells unconstrained
+            solver->exact = 0;
+            info[COMPONENT_LIMIT] = -1;
+            continue;
+        }
+
+        for (k = 0; k <= limit; k++) {
+            solutions[k] /= largest;
+        }
+        for (d = 0; d < size * (limit + 1); d++) {
+            cellMines[d] /= largest;
+        }
+
+        info[COMPONENT_COUNTS] = (int)offset;
+        info[COMPONENT_LIMIT] = limit;
+        offset += entries;
+    }
+    return 1;
+}
+
+/**
+ * Convolves the mine total distributions of every counted component except `skip` into `result`.
+ *
+ * Returns:
+ *   - int: The highest mine total of the result.
+ */
+static int mixComponents(const Solver *solver, int components, int skip, double *result, double *scratch) {
+    int total = 0, c, k, t;
+    result[0] = 1;
+
+    for (c = 0; c < components; c++) {
+        const int *info = &solver->componentInfo[c * COMPONENT_FIELDS];
+        int limit = info[COMPONENT_LIMIT];
+        if (c == skip || limit < 0) continue;
+
+        const double *solutions = solver->counts + info[COMPONENT_COUNTS];
+        for (t = 0; t <= total + limit; t++) {
+            scratch[t] = 0;
+        }
+        for (t = 0; t <= total; t++) {
+            if (result[t] == 0) continue;
+            for (k = 0; k <= limit; k++) {
+                scratch[t + k] += result[t] * solutions[k];
+            }
+        }
+        total += limit;
+        memcpy(result, scratch, (total + 1) * sizeof(double));
+    }
+    return total;
+}
+
+/**
+ * Combines the components with the number of mines left: a set of component solutions with K mines in total is
+ * weighted by the number of ways to put the other minesLeft - K mines in the `outside` cells no number touches,
+ * C(outside, minesLeft - K). The weights are computed with lgamma and scaled so the largest is 1.
+ * Writes the probability of every frontier cell and returns the probability of an outside cell.
+ *
+ * Returns:
+ *   - double: The mine probability of a cell outside the counted components, or -1 if the buffers could not grow.
+ */
+static double combineComponents(Solver *solver, int components, int minesLeft, int outside) {
+    int c, k, t, d, maxTotal = 0;
+    for (c = 0; c < components; c++) {
+        int limit = solver->componentInfo[c * COMPONENT_FIELDS + COMPONENT_LIMIT];
+        maxTotal += limit > 0 ? limit : 0;
+    }
+
+    // weights | total distribution | distribution without one component | convolution scratch | per component weights
+    long length = maxTotal + 1;
+    if (!reserveDoubles(&solver->mixes, &solver->mixesCapacity, 5 * length)) {
+        return -1;
+    }
+    double *weight = solver->mixes;
+    double *total = weight + length;
+    double *others = total + length;
+    double *scratch = others + length;
+    double *componentWeight = scratch + length;
+
+    // Weight of every total number of mines in the components
+    double largest = -HUGE_VAL;
+    for (t = 0; t <= maxTotal; t++) {
+        int rest = minesLeft - t;
+        weight[t] = (rest < 0 || rest > outside) ? -HUGE_VAL : lgamma(outside + 1.0) - lgamma(rest + 1.0) - lgamma(outside - rest + 1.0);
+        if (weight[t] > largest) {
+            largest = weight[t];
+        }
+    }
+    for (t = 0; t <= maxTotal; t++) {
+        // Without any valid total the board is inconsistent, fall back to ignoring the mine count
+        weight[t] = largest == -HUGE_VAL ? 1 : exp(weight[t] - largest);
+    }
+
+    int totalMax = mixComponents(solver, components, -1, total, scratch);
+    double norm = 0, outsideMines = 0, outsideSafe = 0;
+    for (t = 0; t <= totalMax; t++) {
+        int rest = minesLeft - t;
+        norm += total[t] * weight[t];
+        outsideMines += total[t] * weight[t] * rest;
+        outsideSafe += total[t] * weight[t] * (outside - rest);
+    }
+    if (norm <= 0) {
+        solver->exact = 0;
+        norm = 1;
+    }
+
+    for (c = 0; c < components; c++) {
+        const int *info = &solver->componentInfo[c * COMPONENT_FIELDS];
+        int limit = info[COMPONENT_LIMIT];
+        if (limit < 0) continue;
+
+        // Weight of each mine total of this component once the other components are summed out
+        int othersMax = mixComponents(solver, components, c, others, scratch);
+        for (k = 0; k <= limit; k++) {
+            componentWeight[k] = 0;
+            for (t = 0; t <= othersMax; t++) {
+                componentWeight[k] += others[t] * weight[k + t];
+            }
+        }
+
+        const double *solutions = solver->counts + info[COMPONENT_COUNTS];
+        const double *cellMines = solutions + limit + 1;
+        for (d = 0; d < info[COMPONENT_SIZE]; d++) {
+            double mineWeight = 0, safeWeight = 0;
+            for (k = 0; k <= limit; k++) {
+                mineWeight += cellMines[d * (limit + 1) + k] * componentWeight[k];
+                safeWeight += (solutions[k] - cellMines[d * (limit + 1) + k]) * componentWeight[k];
+            }
+
+            int cell = solver->frontier[info[COMPONENT_START] + d];
+            solver->probability[cell] = mineWeight / norm;
+            if (mineWeight == 0) {
+                solver->state[cell] = SOLVER_SAFE;
+            } else if (safeWeight == 0) {
+                solver->state[cell] = SOLVER_MINE;
+            }
+        }
+    }
+
+    if (outside == 0 || outsideMines == 0) {
+        return 0;
+    }
+    if (outsideSafe == 0) {
+        return 1;
+    }
+    return outsideMines / norm / outside;
+}
+
+/**
+ * Computes the probability of a mine in every covered cell of the field from what the player can see.
+ * 1. Trivial rules: numbers whose missing mines fill exactly their unknown neighbours, or that are already
+ *    satisfied, decide their neighbours (repeated until nothing changes).
+ * 2. The remaining revealed numbers become constraints, and the unknown cells they touch (the frontier) are
+ *    grouped into independent components.
+ * 3. Each component is counted (see countComponent): its solutions and each cell's mines for every mine total.
+ * 4. The components are combined with the global number of mines left, weighting each mine total by the ways the
+ *    rest of the mines fit in the cells no number touches.
+ * Cells whose probability comes out exactly 0 or 1 are reported as proven safe or mines.
+ *
+ * Parameters:
+ *   - Solver *solver: The solver (reallocated if the field doesn't have its size).
+ *   - const MineField *field: The field to solve, only its revealed cells and their numbers are read.
+ *
+ * Returns:
+ *   - int: 1 if the probabilities were computed, 0 if memory could not be allocated.
+ */
+int solveMineField(Solver *solver, const MineField *field) {
+    const Board *board = &field->grid;
+    if (solver->rows != board->rows || solver->cols != board->cols || !solver->state) {
+        freeSolver(solver);
+        if (!initSolver(solver, board->rows, board->cols)) {
+            printf("Failed to allocate memory for the solver\n");
+            return 0;
+        }
+    }
+
+    int cells = board->rows * board->cols;
+    int index, c;
+    solver->knownSafe = 0;
+    solver->knownMines = 0;
+    solver->components = 0;
+    solver->exact = 1;
+    solver->states = 0;
+    for (index = 0; index < cells; index++) {
+        solver->state[index] = getBoardBit(board->revealed, index) ? SOLVER_REVEALED : SOLVER_UNKNOWN;
+        solver->cellConstraint[index] = -1;
+        solver->frontierId[index] = -1;
+    }
+
+    applyTrivialRules(solver, board);
+    int frontierCount = buildConstraints(solver, board);
+    int components = groupComponents(solver, frontierCount);
+    int minesLeft = field->numMines - solver->knownMines;
+
+    if (!countComponents(solver, components, minesLeft)) {
+        printf("Failed to allocate memory for the solver\n");
+        return 0;
+    }
+
+    // Cells outside the counted components: never touched by a number, or in a component over budget
+    int outside = 0;
+    for (index = 0; index < cells; index++) {
+        outside += solver->state[index] == SOLVER_UNKNOWN && solver->frontierId[index] < 0;
+    }
+    for (c = 0; c < components; c++) {
+        const int *info = &solver->componentInfo[c * COMPONENT_FIELDS];
+        if (info[COMPONENT_LIMIT] < 0) {
+            outside += info[COMPONENT_SIZE];
+        } else {
+            solver->components++;
+        }
+    }
+
+    double outsideProbability = combineComponents(solver, components, minesLeft, outside);
+    if (outsideProbability < 0) {
+        printf("Failed to allocate memory for the solver\n");
+        return 0;
+    }
+
+    // Count the proven cells again, the counting and the mine count can prove more than the trivial rules
+    solver->knownSafe = 0;
+    solver->knownMines = 0;
+    for (index = 0; index < cells; index++) {
+        if (solver->state[index] == SOLVER_UNKNOWN && solver->frontierId[index] < 0) {
+            solver->probability[index] = outsideProbability;
+            if (outsideProbability == 0) {
+                solver->state[index] = SOLVER_SAFE;
+            } else if (outsideProbability == 1) {
+                solver->state[index] = SOLVER_MINE;
+            }
+        }
+
+        switch (solver->state[index]) {
+            case SOLVER_REVEALED:
+                solver->probability[index] = 0;
+                break;
+            case SOLVER_SAFE:
+                solver->probability[index] = 0;
+                solver->knownSafe++;
+                break;
+            case SOLVER_MINE:
+                solver->probability[index] = 1;
+                solver->knownMines++;
+                break;
+        }
+    }
+
+    // Cells of components over budget also take the outside probability
+    for (c = 0; c < components; c++) {
+        const int *info = &solver->componentInfo[c * COMPONENT_FIELDS];
+        int d;
+        if (info[COMPONENT_LIMIT] >= 0) continue;
+        for (d = 0; d < info[COMPONENT_SIZE]; d++) {
+            solver->probability[solver->frontier[info[COMPONENT_START] + d]] = outsideProbability;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Finds the covered, unflagged cell with the lowest mine probability of the last solve
+ * (the first one in row order on ties, so the choice is deterministic).
+ *
+ * Parameters:
+ *   - const Solver *solver: A solver that has just solved the field.
+ *   - const MineField *field: The field that was solved.
+ *   - int *row: Set to the row of the cell.
+ *   - int *col: Set to the column of the cell.
+ *
+ * Returns:
+ *   - int: 1 if a cell was found, 0 if every cell is revealed or flagged.
+ */
+int findSafestCell(const Solver *solver, const MineField *field, int *row, int *col) {
+    const Board *board = &field->grid;
+    int cells = board->rows * board->cols;
+    int index, best = -1;
+
+    for (index = 0; index < cells; index++) {
+        if (getBoardBit(board->revealed, index) || getBoardBit(board->flagged, index)) continue;
+        if (best < 0 || solver->probability[index] < solver->probability[best]) {
+            best = index;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+    *row = best / board->cols;
+    *col = best % board->cols;
+    return 1;
+}
@@ -0,0 +1,146 @@
+#include "../include/surface_format.h"
+#include "../include/frame_bands.h"
+#include <SDL.h>
+
+// Blits done through blitSurface, and how many of them had to convert pixels
+static long blitCount = 0;
+static long slowBlitCount = 0;
+
+/**
+ * Makes a copy of a surface in the pixel format of the window, so blitting it to the window copies pixels
+ * instead of converting every one of them. Surfaces with an alpha channel keep it (SDL_DisplayFormatAlpha),
+ * the others keep their colour key (SDL_DisplayFormat).
+ *
+ * Parameters:
+ *   - SDL_Surface *surface: The surface to copy (left untouched).
+ *
+ * Returns:
+ *   - SDL_Surface*: The converted copy, or NULL if there is no window yet or the conversion failed.
+ */
+SDL_Surface* displayFormatCopy(SDL_Surface *surface) {
+    if (!surface || !SDL_GetVideoSurface()) {
+        return NULL;
+    }
+    return surface->format->Amask ? SDL_DisplayFormatAlpha(surface) : SDL_DisplayFormat(surface);
+}
+
+/**
+ * Converts a surface to the pixel format of the window once, at load time (and again after the video mode
+ * changed). The original surface is freed; if the conversion fails it is kept as it is.
+ *
+ * Parameters:
+ *   - SDL_Surface *surface: The surface to convert.
+ *
+ * Returns:
+ *   - SDL_Surface*: The surface to use from now on.
+ */
+SDL_Surface* convertToDisplayFormat(SDL_Surface *surface) {
+    SDL_Surface *converted = displayFormatCopy(surface);
+    if (!converted) {
+        return surface;
+    }
+    SDL_FreeSurface(surface);
+    return converted;
+}
+
+/**
+ * Checks if two pixel formats store the pixels the same way (depth and colour masks).
+ *
+ * Parameters:
+ *   - const SDL_PixelFormat *a: The first format.
+ *   - const SDL_PixelFormat *b: The second format.
+ *
+ * Returns:
+ *   - int: 1 if the formats match, 0 otherwise.
+ */
+int isSameFormat(const SDL_PixelFormat *a, const SDL_PixelFormat *b) {
+    return a->BitsPerPixel == b->BitsPerPixel && a->Rmask == b->Rmask && a->Gmask == b->Gmask &&
+           a->Bmask == b->Bmask;
+}
+
+/**
+ * Checks if drawing a surface hides everything under it: surfaces without an alpha channel or colour key are
+ * opaque, and surfaces with an alpha channel are opaque when every pixel has the full alpha. The pixels are
+ * read, so this is meant to be called once when an image is loaded.
+ *
+ * Parameters:
+ *   - SDL_Surface *surface: The surface to check.
+ *
+ * Returns:
+ *   - int: 1 if the surface is fully opaque, 0 otherwise.
+ */
+int isOpaqueSurface(SDL_Surface *surface) {
+    if (!surface || (surface->flags & SDL_SRCCOLORKEY)) {
+        return 0;
+    }
+    if (!surface->format->Amask) {
+        return 1;
+    }
+    if (surface->format->BytesPerPixel != 4) {
+        return 0;  // Alpha surfaces made by SDL_DisplayFormatAlpha are 32 bits
+    }
+
+    int x, y, opaque = 1;
+    SDL_LockSurface(surface);
+    for (y = 0; y < surface->h && opaque; y++) {
+        Uint32 *row = (Uint32*)((Uint8*)surface->pixels + y * surface->pitch);
+        for (x = 0; x < surface->w; x++) {
+            if ((row[x] & surface->format->Amask) != surface->format->Amask) {
+                opaque = 0;
+                break;
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return opaque;
+}
+
+/**
+ * Blits a surface like SDL_BlitSurface and counts the blit. A blit whose source doesn't have the pixel format
+ * of its destination takes SDL's slow path (every pixel is converted), those are counted apart so the surfaces
+ * that missed the display format conversion show up in the stats.
+ *
+ * Parameters:
+ *   - SDL_Surface *source: The surface to copy from.
+ *   - SDL_Rect *sourceRect: The area to copy (NULL for the whole surface).
+ *   - SDL_Surface *destination: The surface to copy to.
+ *   - SDL_Rect *destinationRect: The position to copy to (NULL for the top left corner), clipped by SDL.
+ *
+ * Returns:
+ *   - int: The result of SDL_BlitSurface (0 on success), or -1 if a surface is missing.
+ */
+int blitSurface(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *destination, SDL_Rect *destinationRect) {
+    if (!source || !destination) {
+        return -1;
+    }
+
+    flushBandsBefore(source, destination);  // Layers queued for the bands are drawn first
+    countBlit(source, destination);
+    return SDL_BlitSurface(source, sourceRect, destination, destinationRect);
+}
+
+/**
+ * Counts a blit done outside blitSurface (the blits queued for the frame bands).
+ *
+ * Parameters:
+ *   - SDL_Surface *source: The surface copied from.
+ *   - SDL_Surface *destination: The surface copied to.
+ */
+void countBlit(SDL_Surface *source, SDL_Surface *destination) {
+    blitCount++;
+    if (!isSameFormat(source->format, destination->format)) {
+        slowBlitCount++;
+    }
+}
+
+/**
+ * Reads the blit counters.
+ *
+ * Parameters:
+ *   - long *blits: Receives the number of blits done through blitSurface.
+ *   - long *slowBlits: Receives how many of them had to convert the pixel format.
+ */
+void getBlitStats(long *blits, long *slowBlits) {
+    *blits = blitCount;
+    *slowBlits = slowBlitCount;
+}
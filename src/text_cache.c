@@ -0,0 +1,123 @@
+#include "../include/text_cache.h"
+#include "../include/surface_format.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Rendered labels of the widgets (one cache for the whole game)
+static TextCache textCache;
+
+/**
+ * Hashes a string with FNV-1a.
+ */
+static Uint32 hashText(const char *text) {
+    Uint32 hash = 2166136261u;
+    while (*text) {
+        hash = (hash ^ (unsigned char)*text++) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Returns the surface of a text rendered with TTF_RenderText_Solid, from the cache when the same text was
+ * rendered with the same font and colour before. On a miss the text is rendered, converted to the pixel format
+ * of the window and stored in a free entry, or in place of the least recently used one when the cache is full.
+ *
+ * Parameters:
+ *   - TTF_Font *font: The font to render the text with.
+ *   - const char *text: The text to render.
+ *   - SDL_Color color: The colour of the text.
+ *
+ * Returns:
+ *   - SDL_Surface*: The rendered text (owned by the cache), or NULL if the text couldn't be rendered.
+ */
+SDL_Surface* getTextSurface(TTF_Font *font, const char *text, SDL_Color color) {
+    Uint32 hash = hashText(text);
+    int i, victim = 0;
+
+    textCache.useCounter++;
+    for (i = 0; i < TEXT_CACHE_SIZE; i++) {
+        TextCacheEntry *entry = &textCache.entries[i];
+        if (!entry->text) {
+            victim = i;  // Free entries are used before anything is evicted
+            continue;
+        }
+        if (entry->hash == hash && entry->font == font && entry->color.r == color.r && entry->color.g == color.g &&
+            entry->color.b == color.b && strcmp(entry->text, text) == 0) {
+            entry->lastUsed = textCache.useCounter;
+            textCache.hits++;
+            return entry->surface;
+        }
+        if (textCache.entries[victim].text && entry->lastUsed < textCache.entries[victim].lastUsed) {
+            victim = i;
+        }
+    }
+
+    textCache.misses++;
+    SDL_Surface *surface = convertToDisplayFormat(TTF_RenderText_Solid(font, text, color));
+    char *copy = malloc(strlen(text) + 1);
+    if (!surface || !copy) {
+        SDL_FreeSurface(surface);
+        free(copy);
+        return NULL;
+    }
+    strcpy(copy, text);
+
+    // Replace the victim (a free entry, or the least recently used one)
+    TextCacheEntry *entry = &textCache.entries[victim];
+    if (entry->text) {
+        textCache.evictions++;
+        SDL_FreeSurface(entry->surface);
+        free(entry->text);
+    }
+    entry->font = font;
+    entry->text = copy;
+    entry->hash = hash;
+    entry->color = color;
+    entry->surface = surface;
+    entry->lastUsed = textCache.useCounter;
+    return surface;
+}
+
+/**
+ * Reads the counters of the text cache.
+ *
+ * Parameters:
+ *   - long *hits: Receives the number of lookups served from the cache.
+ *   - long *misses: Receives the number of lookups that had to render the text.
+ *   - long *evictions: Receives the number of surfaces dropped to make room.
+ */
+void getTextCacheStats(long *hits, long *misses, long *evictions) {
+    *hits = textCache.hits;
+    *misses = textCache.misses;
+    *evictions = textCache.evictions;
+}
+
+/**
+ * Converts the cached surfaces to the pixel format of the window again, after the video mode changed.
+ */
+void convertTextCache() {
+    int i;
+    for (i = 0; i < TEXT_CACHE_SIZE; i++) {
+        if (textCache.entries[i].text) {
+            textCache.entries[i].surface = convertToDisplayFormat(textCache.entries[i].surface);
+        }
+    }
+}
+
+/**
+ * Frees every surface of the text cache. This must be done before the fonts are closed, since the entries
+ * are keyed by font pointers.
+ */
+void freeTextCache() {
+    int i;
+    for (i = 0; i < TEXT_CACHE_SIZE; i++) {
+        TextCacheEntry *entry = &textCache.entries[i];
+        if (entry->text) {
+            SDL_FreeSurface(entry->surface);
+            free(entry->text);
+        }
+    }
+    memset(&textCache, 0, sizeof(TextCache));
+}
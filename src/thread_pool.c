@@ -0,0 +1,186 @@
+#include "../include/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Run of chunks owned by one worker, the owner takes from begin, thieves take from end
+typedef struct {
+    pthread_mutex_t lock;
+    long begin;
+    long end;
+} ChunkRun;
+
+// State shared by the workers of one parallelFor call
+typedef struct {
+    ChunkRun *runs;
+    int workers;
+    long count;
+    long chunkSize;
+    ParallelTask task;
+    void *context;
+} ParallelLoop;
+
+// Argument of one worker thread
+typedef struct {
+    ParallelLoop *loop;
+    int worker;
+} WorkerArgument;
+
+/**
+ * Returns the number of cores available to the process (at least 1).
+ */
+int getCoreCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+/**
+ * Takes the next chunk from the front of the worker's own run.
+ */
+static int takeOwnChunk(ChunkRun *run, long *chunk) {
+    int found = 0;
+    pthread_mutex_lock(&run->lock);
+    if (run->begin < run->end) {
+        *chunk = run->begin++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&run->lock);
+    return found;
+}
+
+/**
+ * Steals a chunk from the back of the run with the most chunks left.
+ */
+static int stealChunk(ParallelLoop *loop, int worker, long *chunk) {
+    for (;;) {
+        int i, victim = -1;
+        long most = 0;
+
+        // Pick the fullest run (the sizes are read without the lock, the steal itself re-checks them)
+        for (i = 0; i < loop->workers; i++) {
+            long left = __atomic_load_n(&loop->runs[i].end, __ATOMIC_RELAXED) - __atomic_load_n(&loop->runs[i].begin, __ATOMIC_RELAXED);
+            if (i != worker && left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return 0;
+        }
+
+        ChunkRun *run = &loop->runs[victim];
+        pthread_mutex_lock(&run->lock);
+        if (run->begin < run->end) {
+            *chunk = --run->end;
+            pthread_mutex_unlock(&run->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&run->lock);
+    }
+}
+
+/**
+ * Thread function: runs chunks until its own run and every other run are empty.
+ */
+static void *runWorker(void *argument) {
+    WorkerArgument *worker = argument;
+    ParallelLoop *loop = worker->loop;
+    long chunk;
+
+    while (takeOwnChunk(&loop->runs[worker->worker], &chunk) || stealChunk(loop, worker->worker, &chunk)) {
+        long begin = chunk * loop->chunkSize;
+        long end = begin + loop->chunkSize < loop->count ? begin + loop->chunkSize : loop->count;
+        loop->task(loop->context, worker->worker, begin, end);
+    }
+    return NULL;
+}
+
+/**
+ * Runs task over the items [0, count), cut into chunks of chunkSize items, on `workers` threads.
+ * Worker 0 is the calling thread. The call returns when every chunk has been processed.
+ *
+ * Parameters:
+ *   - long count: Number of items.
+ *   - long chunkSize: Number of items given to the task at a time.
+ *   - int workers: Number of threads (0 or less uses every core).
+ *   - ParallelTask task: Function run on every chunk.
+ *   - void *context: Pointer passed to every call of task.
+ *
+ * Returns:
+ *   - int: 1 if every chunk was run, 0 if the threads could not be set up.
+ */
+int parallelFor(long count, long chunkSize, int workers, ParallelTask task, void *context) {
+    if (count <= 0) {
+        return 1;
+    }
+    if (chunkSize <= 0) {
+        chunkSize = 1;
+    }
+    if (workers <= 0) {
+        workers = getCoreCount();
+    }
+
+    long chunks = (count + chunkSize - 1) / chunkSize;
+    if (workers > chunks) {
+        workers = (int)chunks;
+    }
+
+    ParallelLoop loop;
+    loop.workers = workers;
+    loop.count = count;
+    loop.chunkSize = chunkSize;
+    loop.task = task;
+    loop.context = context;
+    loop.runs = malloc(workers * sizeof(ChunkRun));
+    WorkerArgument *arguments = malloc(workers * sizeof(WorkerArgument));
+    pthread_t *threads = malloc(workers * sizeof(pthread_t));
+    if (!loop.runs || !arguments || !threads) {
+        printf("Failed to allocate memory for the worker threads\n");
+        free(loop.runs);
+        free(arguments);
+        free(threads);
+        return 0;
+    }
+
+    // Give every worker an equal run of consecutive chunks
+    int i;
+    for (i = 0; i < workers; i++) {
+        pthread_mutex_init(&loop.runs[i].lock, NULL);
+        loop.runs[i].begin = chunks * i / workers;
+        loop.runs[i].end = chunks * (i + 1) / workers;
+        arguments[i].loop = &loop;
+        arguments[i].worker = i;
+    }
+
+    // Start the other workers, the calling thread is worker 0
+    int started = 1;
+    for (i = 1; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, runWorker, &arguments[i]) != 0) {
+            break;  // The chunks of workers that didn't start get stolen by the others
+        }
+        started++;
+    }
+    runWorker(&arguments[0]);
+    for (i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < workers; i++) {
+        pthread_mutex_destroy(&loop.runs[i].lock);
+    }
+    free(loop.runs);
+    free(arguments);
+    free(threads);
+    return 1;
+}
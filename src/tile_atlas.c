@@ -0,0 +1,210 @@
+#include "../include/tile_atlas.h"
+#include "../include/surface_format.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Builds the atlas: the 12 cell images copied side by side into one surface, tile t at x = t * size, in the
+ * pixel format of the target surface (the window), so compositeGrid can copy its rows straight into it.
+ * The images are copied, so the caller can release them afterwards. A NULL image leaves its tile black.
+ * The cell images are opaque (JPEG); an image with an alpha channel would be flattened over black.
+ *
+ * Parameters:
+ *   - TileAtlas *atlas: The atlas to build (its previous surface is freed once the new one is ready).
+ *   - SDL_Surface *tiles[TILE_COUNT]: The cell images at size x size, in the tile order of tile_atlas.h.
+ *   - int size: The cell size.
+ *   - SDL_Surface *target: A surface in the pixel format the atlas is drawn to.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if the surface couldn't be created (the previous atlas is kept).
+ */
+int buildTileAtlas(TileAtlas *atlas, SDL_Surface *tiles[TILE_COUNT], int size, SDL_Surface *target) {
+    if (!target || size <= 0) {
+        return 0;
+    }
+
+    SDL_PixelFormat *format = target->format;
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, size * TILE_COUNT, size, format->BitsPerPixel,
+                                                format->Rmask, format->Gmask, format->Bmask, 0);
+    if (!surface) {
+        printf("Failed to create the tile atlas: %s\n", SDL_GetError());
+        return 0;
+    }
+    if (format->palette) {
+        SDL_SetColors(surface, format->palette->colors, 0, format->palette->ncolors);
+    }
+
+    int i;
+    for (i = 0; i < TILE_COUNT; i++) {
+        if (tiles[i]) {
+            SDL_Rect destRect = {i * size, 0, size, size};
+            blitSurface(tiles[i], NULL, surface, &destRect);
+        }
+    }
+
+    if (atlas->surface) {
+        SDL_FreeSurface(atlas->surface);
+    }
+    atlas->surface = surface;
+    atlas->size = size;
+    return 1;
+}
+
+/**
+ * Frees the atlas surface and the row buffer of the compositor.
+ *
+ * Parameters:
+ *   - TileAtlas *atlas: The atlas to free (it can be built again afterwards).
+ */
+void freeTileAtlas(TileAtlas *atlas) {
+    if (atlas->surface) {
+        SDL_FreeSurface(atlas->surface);
+    }
+    free(atlas->rowTiles);
+    atlas->surface = NULL;
+    atlas->rowTiles = NULL;
+    atlas->rowCapacity = 0;
+    atlas->size = 0;
+}
+
+/**
+ * Picks the tile that shows a cell: the bomb, the number of adjacent mines or the empty cell when it is revealed,
+ * the flag when it is flagged, and the covered cell otherwise.
+ *
+ * Parameters:
+ *   - const Board *board: The board.
+ *   - int row: The row of the cell.
+ *   - int col: The column of the cell.
+ *
+ * Returns:
+ *   - int: The tile index.
+ */
+int cellTile(const Board *board, int row, int col) {
+    if (isRevealedCell(board, row, col)) {
+        if (isMineCell(board, row, col)) {
+            return TILE_BOMB;
+        }
+        int adjacentMines = getAdjacentMines(board, row, col);
+        return adjacentMines > 0 ? adjacentMines - 1 : TILE_EMPTY;
+    }
+    return isFlaggedCell(board, row, col) ? TILE_FLAG : TILE_COVERED;
+}
+
+/**
+ * Draws one tile of the atlas with a blit (for the few cells that change between frames).
+ *
+ * Parameters:
+ *   - SDL_Surface *screen: The surface to draw on.
+ *   - const TileAtlas *atlas: The atlas.
+ *   - int tile: The tile index.
+ *   - int x: The x-coordinate of the cell.
+ *   - int y: The y-coordinate of the cell.
+ */
+void drawTile(SDL_Surface *screen, const TileAtlas *atlas, int tile, int x, int y) {
+    if (!atlas->surface) {
+        return;
+    }
+    SDL_Rect sourceRect = {tile * atlas->size, 0, atlas->size, atlas->size};
+    SDL_Rect destRect = {x, y, atlas->size, atlas->size};
+    blitSurface(atlas->surface, &sourceRect, screen, &destRect);
+}
+
+/**
+ * Makes the row buffer hold the tiles of a whole row of the board.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if the memory couldn't be allocated.
+ */
+static int reserveRowTiles(TileAtlas *atlas, int cols) {
+    if (cols <= atlas->rowCapacity) {
+        return 1;
+    }
+    int *rowTiles = realloc(atlas->rowTiles, cols * sizeof(int));
+    if (!rowTiles) {
+        printf("Memory allocation failed for the tile atlas rows\n");
+        return 0;
+    }
+    atlas->rowTiles = rowTiles;
+    atlas->rowCapacity = cols;
+    return 1;
+}
+
+/**
+ * Draws every cell of a board in one pass over the pixels, instead of one blit per cell: for each row of cells
+ * the tiles are looked up once, then every pixel row of the screen is filled by copying, for each cell, its span
+ * of the matching row of the atlas with memcpy. The drawing is clipped to the clip rect of the screen (cells cut
+ * by its edges copy only their visible part). When the screen isn't in the format of the atlas (it changed
+ * and the atlas wasn't rebuilt yet) the cells are blitted one by one, which converts the pixels.
+ *
+ * Parameters:
+ *   - SDL_Surface *screen: The surface to draw on (typically the window).
+ *   - TileAtlas *atlas: The atlas, built for the cell size of the board.
+ *   - const Board *board: The board to draw.
+ *   - int originX: The x-coordinate of the top left corner of the grid.
+ *   - int originY: The y-coordinate of the top left corner of the grid.
+ */
+void compositeGrid(SDL_Surface *screen, TileAtlas *atlas, const Board *board, int originX, int originY) {
+    int size = atlas->size;
+    int row, col, y;
+    if (!atlas->surface) {
+        return;
+    }
+
+    if (!isSameFormat(screen->format, atlas->surface->format) || !reserveRowTiles(atlas, board->cols)) {
+        for (row = 0; row < board->rows; row++) {
+            for (col = 0; col < board->cols; col++) {
+                drawTile(screen, atlas, cellTile(board, row, col), originX + col * size, originY + row * size);
+            }
+        }
+        return;
+    }
+
+    // Visible part of the grid on the screen
+    SDL_Rect clip = screen->clip_rect;
+    int left = originX > clip.x ? originX : clip.x;
+    int top = originY > clip.y ? originY : clip.y;
+    int right = originX + board->cols * size;
+    int bottom = originY + board->rows * size;
+    if (right > clip.x + clip.w) right = clip.x + clip.w;
+    if (bottom > clip.y + clip.h) bottom = clip.y + clip.h;
+    if (left >= right || top >= bottom) {
+        return;
+    }
+    int firstCol = (left - originX) / size, lastCol = (right - 1 - originX) / size;
+    int firstRow = (top - originY) / size, lastRow = (bottom - 1 - originY) / size;
+
+    if (SDL_MUSTLOCK(screen) && SDL_LockSurface(screen) < 0) {
+        return;
+    }
+    int bytesPerPixel = screen->format->BytesPerPixel;
+    Uint8 *atlasPixels = atlas->surface->pixels;
+
+    for (row = firstRow; row <= lastRow; row++) {
+        int cellTop = originY + row * size;
+        int rowTop = cellTop > top ? cellTop : top;
+        int rowBottom = cellTop + size < bottom ? cellTop + size : bottom;
+
+        for (col = firstCol; col <= lastCol; col++) {
+            atlas->rowTiles[col] = cellTile(board, row, col);
+        }
+
+        for (y = rowTop; y < rowBottom; y++) {
+            Uint8 *destRow = (Uint8*)screen->pixels + y * screen->pitch;
+            Uint8 *sourceRow = atlasPixels + (y - cellTop) * atlas->surface->pitch;
+            for (col = firstCol; col <= lastCol; col++) {
+                int cellLeft = originX + col * size;
+                int spanLeft = cellLeft > left ? cellLeft : left;
+                int spanRight = cellLeft + size < right ? cellLeft + size : right;
+                int sourceX = atlas->rowTiles[col] * size + spanLeft - cellLeft;
+                memcpy(destRow + spanLeft * bytesPerPixel, sourceRow + sourceX * bytesPerPixel,
+                       (size_t)(spanRight - spanLeft) * bytesPerPixel);
+            }
+        }
+    }
+
+    if (SDL_MUSTLOCK(screen)) {
+        SDL_UnlockSurface(screen);
+    }
+}
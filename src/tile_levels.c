@@ -0,0 +1,230 @@
+#include "../include/tile_levels.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Makes a 32-bit ARGB surface, the format every level is kept in.
+ */
+static SDL_Surface* createLevelSurface(int width, int height) {
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32,
+                                                0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    if (!surface) {
+        printf("Failed to create a tile level: %s\n", SDL_GetError());
+    }
+    return surface;
+}
+
+/**
+ * Averages one row of 2x2 blocks: out[x] = (a[2x] + a[2x + 1] + b[2x] + b[2x + 1] + 2) / 4 for every channel.
+ * The SSE2 path does 4 output pixels at a time with the same rounding, so both paths give the same bytes.
+ */
+static void halveRow(const Uint8 *rowA, const Uint8 *rowB, Uint8 *out, int width) {
+    int x = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i two = _mm_set1_epi16(2);
+    for (; x + 4 <= width; x += 4) {
+        const Uint8 *a = rowA + x * 8, *b = rowB + x * 8;
+        __m128i a0 = _mm_loadu_si128((const __m128i *)a), a1 = _mm_loadu_si128((const __m128i *)(a + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i *)b), b1 = _mm_loadu_si128((const __m128i *)(b + 16));
+
+        // Vertical sums of the 8 source pixels, 2 pixels (8 channels of 16 bits) per register
+        __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        // Horizontal sums: the pixel in the high half added to the one in the low half
+        s01 = _mm_add_epi16(s01, _mm_srli_si128(s01, 8));
+        s23 = _mm_add_epi16(s23, _mm_srli_si128(s23, 8));
+        s45 = _mm_add_epi16(s45, _mm_srli_si128(s45, 8));
+        s67 = _mm_add_epi16(s67, _mm_srli_si128(s67, 8));
+
+        __m128i low = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s01, s23), two), 2);
+        __m128i high = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s45, s67), two), 2);
+        _mm_storeu_si128((__m128i *)(out + x * 4), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; x < width; x++) {
+        int c;
+        for (c = 0; c < 4; c++) {
+            out[x * 4 + c] = (Uint8)((rowA[x * 8 + c] + rowA[x * 8 + 4 + c] + rowB[x * 8 + c] + rowB[x * 8 + 4 + c] + 2) >> 2);
+        }
+    }
+}
+
+/**
+ * Makes a surface half the size of another (rounded down) with a 2x2 box average.
+ */
+static SDL_Surface* halveSurface(SDL_Surface *source) {
+    SDL_Surface *half = createLevelSurface(source->w / 2, source->h / 2);
+    int y;
+    if (!half) {
+        return NULL;
+    }
+    for (y = 0; y < half->h; y++) {
+        const Uint8 *rowA = (const Uint8*)source->pixels + 2 * y * source->pitch;
+        halveRow(rowA, rowA + source->pitch, (Uint8*)half->pixels + y * half->pitch, half->w);
+    }
+    return half;
+}
+
+/**
+ * Makes a surface of another size with a bilinear filter, sampling at the pixel centres (8-bit weights).
+ * Used for the last step only, from a source less than twice the size, where it is close to a box average.
+ */
+static SDL_Surface* resampleSurface(SDL_Surface *source, int width, int height) {
+    SDL_Surface *scaled = createLevelSurface(width, height);
+    int *columns = malloc(width * 2 * sizeof(int));
+    int x, y, c;
+    if (!scaled || !columns) {
+        if (!columns) printf("Memory allocation failed for a tile level\n");
+        if (scaled) SDL_FreeSurface(scaled);
+        free(columns);
+        return NULL;
+    }
+
+    // Source column and weight of the next column for every destination column, in 16.16 fixed point
+    for (x = 0; x < width; x++) {
+        int position = (int)(((2LL * x + 1) * source->w << 16) / (2 * width)) - 32768;
+        if (position < 0) position = 0;
+        columns[2 * x] = position >> 16;
+        columns[2 * x + 1] = (position >> 8) & 255;
+    }
+
+    for (y = 0; y < height; y++) {
+        int position = (int)(((2LL * y + 1) * source->h << 16) / (2 * height)) - 32768;
+        if (position < 0) position = 0;
+        int row = position >> 16, weightY = (position >> 8) & 255;
+        const Uint8 *top = (const Uint8*)source->pixels + row * source->pitch;
+        const Uint8 *bottom = row + 1 < source->h ? top + source->pitch : top;
+        Uint8 *out = (Uint8*)scaled->pixels + y * scaled->pitch;
+
+        for (x = 0; x < width; x++) {
+            int left = columns[2 * x], weightX = columns[2 * x + 1];
+            int right = left + 1 < source->w ? left + 1 : left;
+            for (c = 0; c < 4; c++) {
+                int upper = top[left * 4 + c] * (256 - weightX) + top[right * 4 + c] * weightX;
+                int lower = bottom[left * 4 + c] * (256 - weightX) + bottom[right * 4 + c] * weightX;
+                out[x * 4 + c] = (Uint8)((upper * (256 - weightY) + lower * weightY + 32768) >> 16);
+            }
+        }
+    }
+
+    free(columns);
+    return scaled;
+}
+
+/**
+ * Builds the levels of a tile from its decoded image: the image is copied into the level format, halved while
+ * it stays at least twice TILE_LEVEL_MAX_SIZE, resampled to the top level, and every other level is the 2x2
+ * average of the one above. The previous levels of the tile are replaced.
+ *
+ * Parameters:
+ *   - TileLevels *levels: The levels of the cell images.
+ *   - int tile: The tile index (see tile_atlas.h).
+ *   - SDL_Surface *image: The decoded image (any format and size, left untouched).
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if a surface couldn't be created (the tile has no levels then).
+ */
+int setTileImage(TileLevels *levels, int tile, SDL_Surface *image) {
+    int level;
+    for (level = 0; level < TILE_LEVELS; level++) {
+        if (levels->levels[tile][level]) {
+            SDL_FreeSurface(levels->levels[tile][level]);
+            levels->levels[tile][level] = NULL;
+        }
+    }
+
+    // Copy the image as it is (alpha included) into the level format
+    SDL_Surface *current = createLevelSurface(image->w, image->h);
+    if (!current) {
+        return 0;
+    }
+    Uint32 flags = image->flags & SDL_SRCALPHA;
+    Uint8 alpha = image->format->alpha;
+    SDL_SetAlpha(image, 0, 0);
+    SDL_BlitSurface(image, NULL, current, NULL);
+    SDL_SetAlpha(image, flags, alpha);
+
+    // Box-halve the large source down to less than twice the top level, then one bilinear step
+    while (current && current->w >= 2 * TILE_LEVEL_MAX_SIZE && current->h >= 2 * TILE_LEVEL_MAX_SIZE) {
+        SDL_Surface *half = halveSurface(current);
+        SDL_FreeSurface(current);
+        current = half;
+    }
+    if (current && (current->w != TILE_LEVEL_MAX_SIZE || current->h != TILE_LEVEL_MAX_SIZE)) {
+        SDL_Surface *top = resampleSurface(current, TILE_LEVEL_MAX_SIZE, TILE_LEVEL_MAX_SIZE);
+        SDL_FreeSurface(current);
+        current = top;
+    }
+    levels->levels[tile][0] = current;
+
+    for (level = 1; level < TILE_LEVELS && levels->levels[tile][level - 1]; level++) {
+        levels->levels[tile][level] = halveSurface(levels->levels[tile][level - 1]);
+    }
+    return hasTileLevels(levels, tile);
+}
+
+/**
+ * Tells if every level of a tile was built.
+ *
+ * Parameters:
+ *   - const TileLevels *levels: The levels of the cell images.
+ *   - int tile: The tile index.
+ *
+ * Returns:
+ *   - int: 1 if the tile can be scaled, 0 otherwise.
+ */
+int hasTileLevels(const TileLevels *levels, int tile) {
+    return levels->levels[tile][TILE_LEVELS - 1] != NULL;
+}
+
+/**
+ * Makes a tile at a cell size from the smallest level at least that large (the top level for larger sizes),
+ * with a bilinear step when the size isn't the size of the level itself.
+ *
+ * Parameters:
+ *   - const TileLevels *levels: The levels of the cell images.
+ *   - int tile: The tile index.
+ *   - int size: The cell size.
+ *
+ * Returns:
+ *   - SDL_Surface*: A new 32-bit ARGB surface of size x size (the caller frees it), or NULL if the tile has no
+ *                   levels or the surface couldn't be created.
+ */
+SDL_Surface* scaleTile(const TileLevels *levels, int tile, int size) {
+    if (!hasTileLevels(levels, tile) || size <= 0) {
+        return NULL;
+    }
+
+    int level = 0;
+    while (level + 1 < TILE_LEVELS && (TILE_LEVEL_MAX_SIZE >> (level + 1)) >= size) {
+        level++;
+    }
+    return resampleSurface(levels->levels[tile][level], size, size);
+}
+
+/**
+ * Frees every level of every tile.
+ *
+ * Parameters:
+ *   - TileLevels *levels: The levels to free (they can be set again afterwards).
+ */
+void freeTileLevels(TileLevels *levels) {
+    int tile, level;
+    for (tile = 0; tile < TILE_COUNT; tile++) {
+        for (level = 0; level < TILE_LEVELS; level++) {
+            if (levels->levels[tile][level]) {
+                SDL_FreeSurface(levels->levels[tile][level]);
+                levels->levels[tile][level] = NULL;
+            }
+        }
+    }
+}
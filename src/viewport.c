@@ -0,0 +1,207 @@
+#include "../include/viewport.h"
+#include <SDL.h>
+
+/**
+ * Keeps the scroll of one axis in range: a grid smaller than the area is centred in it or placed at its end,
+ * a larger one can't be scrolled past its edges.
+ */
+static int clampScroll(int scroll, int gridSize, int areaSize, int centred) {
+    if (gridSize <= areaSize) {
+        return centred ? -(areaSize - gridSize) / 2 : -(areaSize - gridSize);
+    }
+    if (scroll < 0) {
+        return 0;
+    }
+    return scroll > gridSize - areaSize ? gridSize - areaSize : scroll;
+}
+
+/**
+ * Clamps the scroll of both axes. A grid that fits is centred horizontally and sits at the bottom of the area
+ * (where the game always drew it).
+ */
+static void clampViewport(Viewport *viewport) {
+    viewport->scrollX = clampScroll(viewport->scrollX, viewport->cols * viewport->cellSize, viewport->area.w, 1);
+    viewport->scrollY = clampScroll(viewport->scrollY, viewport->rows * viewport->cellSize, viewport->area.h, 0);
+}
+
+/**
+ * Points the viewport at a grid. A grid larger than the area starts scrolled to its centre.
+ *
+ * Parameters:
+ *   - Viewport *viewport: The viewport to set up.
+ *   - SDL_Rect area: The part of the window the grid is drawn in.
+ *   - int rows: The number of rows of the grid.
+ *   - int cols: The number of columns of the grid.
+ *   - int cellSize: The size of a cell.
+ */
+void initViewport(Viewport *viewport, SDL_Rect area, int rows, int cols, int cellSize) {
+    viewport->area = area;
+    viewport->rows = rows;
+    viewport->cols = cols;
+    viewport->cellSize = cellSize;
+    viewport->scrollX = (cols * cellSize - area.w) / 2;
+    viewport->scrollY = (rows * cellSize - area.h) / 2;
+    clampViewport(viewport);
+}
+
+/**
+ * Moves the viewport to another area of the window (after a resize), keeping the zoom. The scroll is kept
+ * where the grid still overflows the area, and clamped again.
+ *
+ * Parameters:
+ *   - Viewport *viewport: The viewport.
+ *   - SDL_Rect area: The new area.
+ */
+void setViewportArea(Viewport *viewport, SDL_Rect area) {
+    viewport->area = area;
+    clampViewport(viewport);
+}
+
+/**
+ * Gives the window position of the top left corner of the grid (outside the area when the grid is scrolled).
+ *
+ * Parameters:
+ *   - const Viewport *viewport: The viewport.
+ *   - int *x: Receives the x-coordinate.
+ *   - int *y: Receives the y-coordinate.
+ */
+void getViewportOrigin(const Viewport *viewport, int *x, int *y) {
+    *x = viewport->area.x - viewport->scrollX;
+    *y = viewport->area.y - viewport->scrollY;
+}
+
+/**
+ * Finds the cell drawn at a window position, with the same transform the grid is drawn with.
+ *
+ * Parameters:
+ *   - const Viewport *viewport: The viewport.
+ *   - int x: The x-coordinate on the window.
+ *   - int y: The y-coordinate on the window.
+ *   - int *row: Receives the row of the cell.
+ *   - int *col: Receives the column of the cell.
+ *
+ * Returns:
+ *   - int: 1 if a cell is drawn there, 0 if the position is outside the area or the grid.
+ */
+int viewportCellAt(const Viewport *viewport, int x, int y, int *row, int *col) {
+    SDL_Rect visible = visibleGridArea(viewport);
+    if (x < visible.x || y < visible.y || x >= visible.x + visible.w || y >= visible.y + visible.h) {
+        return 0;
+    }
+
+    int originX, originY;
+    getViewportOrigin(viewport, &originX, &originY);
+    *col = (x - originX) / viewport->cellSize;  // Not negative inside the visible grid
+    *row = (y - originY) / viewport->cellSize;
+    return 1;
+}
+
+/**
+ * Clips the box (x1, y1) - (x2, y2) of the window to the area and to the grid. The corners are ints because
+ * the grid of a large board goes past the range of the SDL_Rect fields.
+ */
+static int clipBox(const Viewport *viewport, int x1, int y1, int x2, int y2, SDL_Rect *rect) {
+    int originX, originY;
+    getViewportOrigin(viewport, &originX, &originY);
+
+    if (x1 < viewport->area.x) x1 = viewport->area.x;
+    if (y1 < viewport->area.y) y1 = viewport->area.y;
+    if (x1 < originX) x1 = originX;
+    if (y1 < originY) y1 = originY;
+    if (x2 > viewport->area.x + viewport->area.w) x2 = viewport->area.x + viewport->area.w;
+    if (y2 > viewport->area.y + viewport->area.h) y2 = viewport->area.y + viewport->area.h;
+    if (x2 > originX + viewport->cols * viewport->cellSize) x2 = originX + viewport->cols * viewport->cellSize;
+    if (y2 > originY + viewport->rows * viewport->cellSize) y2 = originY + viewport->rows * viewport->cellSize;
+    if (x1 >= x2 || y1 >= y2) {
+        return 0;
+    }
+
+    rect->x = x1;
+    rect->y = y1;
+    rect->w = x2 - x1;
+    rect->h = y2 - y1;
+    return 1;
+}
+
+/**
+ * Gives the part of the window where cells are drawn: the grid clipped to the area of the viewport.
+ *
+ * Parameters:
+ *   - const Viewport *viewport: The viewport.
+ *
+ * Returns:
+ *   - SDL_Rect: The visible part of the grid (empty when nothing is visible).
+ */
+SDL_Rect visibleGridArea(const Viewport *viewport) {
+    SDL_Rect visible = {0, 0, 0, 0};
+    int originX, originY;
+    getViewportOrigin(viewport, &originX, &originY);
+    clipBox(viewport, originX, originY, originX + viewport->cols * viewport->cellSize,
+            originY + viewport->rows * viewport->cellSize, &visible);
+    return visible;
+}
+
+/**
+ * Clips a rect of the window to the area of the viewport and to the grid, for the cells drawn one by one.
+ *
+ * Parameters:
+ *   - const Viewport *viewport: The viewport.
+ *   - SDL_Rect *rect: The rect to clip, changed in place.
+ *
+ * Returns:
+ *   - int: 1 if part of the rect is visible, 0 otherwise (the rect is left unchanged then).
+ */
+int clipToViewport(const Viewport *viewport, SDL_Rect *rect) {
+    return clipBox(viewport, rect->x, rect->y, rect->x + rect->w, rect->y + rect->h, rect);
+}
+
+/**
+ * Scrolls the grid, within its edges. A grid that fits in the area doesn't move.
+ *
+ * Parameters:
+ *   - Viewport *viewport: The viewport.
+ *   - int dx: Pixels to scroll to the right (negative to the left).
+ *   - int dy: Pixels to scroll down (negative up).
+ *
+ * Returns:
+ *   - int: 1 if the grid moved, 0 otherwise.
+ */
+int panViewport(Viewport *viewport, int dx, int dy) {
+    int scrollX = viewport->scrollX, scrollY = viewport->scrollY;
+    viewport->scrollX += dx;
+    viewport->scrollY += dy;
+    clampViewport(viewport);
+    return viewport->scrollX != scrollX || viewport->scrollY != scrollY;
+}
+
+/**
+ * Zooms the grid to another cell size (clamped to MIN_VIEW_CELL_SIZE .. MAX_VIEW_CELL_SIZE). The grid point under
+ * the anchor stays under it, as far as the edges of the grid allow.
+ *
+ * Parameters:
+ *   - Viewport *viewport: The viewport.
+ *   - int cellSize: The new cell size.
+ *   - int anchorX: The x-coordinate on the window that stays on the same grid point (the mouse).
+ *   - int anchorY: The y-coordinate on the window that stays on the same grid point.
+ *
+ * Returns:
+ *   - int: 1 if the cell size changed, 0 otherwise.
+ */
+int zoomViewport(Viewport *viewport, int cellSize, int anchorX, int anchorY) {
+    if (cellSize < MIN_VIEW_CELL_SIZE) cellSize = MIN_VIEW_CELL_SIZE;
+    if (cellSize > MAX_VIEW_CELL_SIZE) cellSize = MAX_VIEW_CELL_SIZE;
+    if (cellSize == viewport->cellSize) {
+        return 0;
+    }
+
+    // Grid pixel under the anchor, scaled to the new size (64-bit so large boards don't overflow)
+    int offsetX = anchorX - viewport->area.x, offsetY = anchorY - viewport->area.y;
+    long long gridX = (long long)(viewport->scrollX + offsetX) * cellSize / viewport->cellSize;
+    long long gridY = (long long)(viewport->scrollY + offsetY) * cellSize / viewport->cellSize;
+
+    viewport->cellSize = cellSize;
+    viewport->scrollX = (int)gridX - offsetX;
+    viewport->scrollY = (int)gridY - offsetY;
+    clampViewport(viewport);
+    return 1;
+}
@@ -0,0 +1,282 @@
+/**
+ * Headless self-play simulator: plays a large number of games per mode with a simple deterministic policy
+ * and reports the win rate, the average opening size and the 3BV distribution of the boards.
+ * The games run on the real engine (placeMines, calculateAdjacentMines, revealCell from the engine library)
+ * and are spread over every core with the work-stealing parallelFor.
+ *
+ * Policy: the first click is the middle of the board, then the two trivial rules are applied to every revealed
+ * number (all covered neighbours are mines / all mines around it are flagged) and when neither rule applies
+ * a covered cell is picked at random.
+ *
+ * Every game gets its own seed (base seed + game index) for both the board and the guesses, so the results are
+ * the same whatever the number of threads.
+ *
+ * Usage: self_play [--games N] [--mode easy|medium|hard|all] [--threads N] [--seed S] [output.json]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/engine.h"
+#include "../include/thread_pool.h"
+
+#define GAMES_PER_CHUNK 256
+
+// Results collected by one worker thread
+typedef struct {
+    MineField field;           // Field reused for every game of the worker
+    long games;
+    long wins;
+    long long openingCells;    // Sum of the cells revealed by the first click
+    long long bbbvSum;         // Sum of the 3BV of the boards
+    long *bbbvGames;           // Number of games for each 3BV value
+    long *bbbvWins;            // Number of wins for each 3BV value
+} WorkerStats;
+
+// Shared settings of a simulation run
+typedef struct {
+    const ModePreset *mode;
+    uint64_t baseSeed;
+    int maxBBBV;               // Size of the 3BV histograms - 1 (the 3BV can't exceed the number of cells)
+    WorkerStats *workers;
+} Simulation;
+
+/**
+ * Applies the two trivial rules to every revealed number of the board.
+ *
+ * Returns:
+ *   - int: 1 if a cell was flagged or revealed, 0 if the rules found nothing.
+ */
+static int applyTrivialRules(MineField *field) {
+    Board *board = &field->grid;
+    int row, col, i, j, moved = 0;
+
+    for (row = 0; row < board->rows && field->gameState == 0; row++) {
+        for (col = 0; col < board->cols && field->gameState == 0; col++) {
+            if (!isRevealedCell(board, row, col)) continue;
+            int mines = getAdjacentMines(board, row, col);
+            if (mines == 0) continue;
+
+            // Count the covered and flagged neighbours
+            int covered = 0, flagged = 0;
+            for (i = row - 1; i <= row + 1; i++) {
+                for (j = col - 1; j <= col + 1; j++) {
+                    if (!isInsideBoard(board, i, j) || isRevealedCell(board, i, j)) continue;
+                    covered++;
+                    flagged += isFlaggedCell(board, i, j);
+                }
+            }
+            if (covered == flagged) continue;
+
+            if (covered == mines) {
+                // Every covered neighbour is a mine
+                for (i = row - 1; i <= row + 1; i++) {
+                    for (j = col - 1; j <= col + 1; j++) {
+                        if (isInsideBoard(board, i, j) && !isRevealedCell(board, i, j) && !isFlaggedCell(board, i, j)) {
+                            toggleFlag(field, i, j);
+                        }
+                    }
+                }
+                moved = 1;
+            } else if (flagged == mines) {
+                // Every mine around it is flagged, the rest is safe
+                for (i = row - 1; i <= row + 1; i++) {
+                    for (j = col - 1; j <= col + 1; j++) {
+                        if (isInsideBoard(board, i, j) && !isFlaggedCell(board, i, j)) {
+                            revealCell(field, i, j);
+                        }
+                    }
+                }
+                moved = 1;
+            }
+        }
+    }
+    return moved;
+}
+
+/**
+ * Reveals a covered, unflagged cell picked at random.
+ */
+static void guessCell(MineField *field, RandomState *rng) {
+    Board *board = &field->grid;
+    int cells = board->rows * board->cols;
+    int index, candidates = 0;
+
+    for (index = 0; index < cells; index++) {
+        candidates += !getBoardBit(board->revealed, index) && !getBoardBit(board->flagged, index);
+    }
+    if (candidates == 0) {
+        return;
+    }
+
+    int pick = (int)randomBelow(rng, (uint32_t)candidates);
+    for (index = 0; index < cells; index++) {
+        if (!getBoardBit(board->revealed, index) && !getBoardBit(board->flagged, index) && pick-- == 0) {
+            revealCell(field, index / board->cols, index % board->cols);
+            return;
+        }
+    }
+}
+
+/**
+ * Plays the games [begin, end) on the worker's field and adds the results to its stats.
+ */
+static void playGames(void *context, int worker, long begin, long end) {
+    Simulation *simulation = context;
+    WorkerStats *stats = &simulation->workers[worker];
+    MineField *field = &stats->field;
+    const ModePreset *mode = simulation->mode;
+    long game;
+
+    for (game = begin; game < end; game++) {
+        uint64_t seed = simulation->baseSeed + (uint64_t)game;
+        RandomState guesses;
+        seedRandom(&guesses, ~seed);
+        restartMineField(field, mode->numMines, seed);
+
+        // The first click places the mines and opens the board
+        int opening = revealCell(field, mode->rows / 2, mode->cols / 2);
+        int bbbv = calculate3BV(field);
+
+        while (field->gameState == 0) {
+            if (!applyTrivialRules(field)) {
+                guessCell(field, &guesses);
+            }
+        }
+
+        stats->games++;
+        stats->openingCells += opening;
+        if (field->gameState == 2) {
+            stats->wins++;
+        }
+        if (bbbv >= 0 && bbbv <= simulation->maxBBBV) {
+            stats->bbbvSum += bbbv;
+            stats->bbbvGames[bbbv]++;
+            if (field->gameState == 2) {
+                stats->bbbvWins[bbbv]++;
+            }
+        }
+    }
+}
+
+/**
+ * Runs the simulation of one mode and writes its results as one JSON object.
+ *
+ * Returns:
+ *   - int: 1 on success, 0 if memory could not be allocated.
+ */
+static int simulateMode(const ModePreset *mode, long games, int threads, uint64_t seed, FILE *out, int first) {
+    Simulation simulation;
+    int i, j;
+
+    simulation.mode = mode;
+    simulation.baseSeed = seed;
+    simulation.maxBBBV = mode->rows * mode->cols;
+    simulation.workers = calloc(threads, sizeof(WorkerStats));
+    if (!simulation.workers) {
+        printf("Failed to allocate memory for the workers\n");
+        return 0;
+    }
+
+    for (i = 0; i < threads; i++) {
+        WorkerStats *stats = &simulation.workers[i];
+        stats->bbbvGames = calloc(simulation.maxBBBV + 1, sizeof(long));
+        stats->bbbvWins = calloc(simulation.maxBBBV + 1, sizeof(long));
+        if (!stats->bbbvGames || !stats->bbbvWins || !initMineField(&stats->field, mode->rows, mode->cols, mode->numMines, seed)) {
+            printf("Failed to allocate memory for the workers\n");
+            return 0;
+        }
+    }
+
+    parallelFor(games, GAMES_PER_CHUNK, threads, playGames, &simulation);
+
+    // Merge the results of the workers into the first one
+    WorkerStats *total = &simulation.workers[0];
+    for (i = 1; i < threads; i++) {
+        WorkerStats *stats = &simulation.workers[i];
+        total->games += stats->games;
+        total->wins += stats->wins;
+        total->openingCells += stats->openingCells;
+        total->bbbvSum += stats->bbbvSum;
+        for (j = 0; j <= simulation.maxBBBV; j++) {
+            total->bbbvGames[j] += stats->bbbvGames[j];
+            total->bbbvWins[j] += stats->bbbvWins[j];
+        }
+    }
+
+    fprintf(out, "%s\n    {\"mode\": \"%s\", \"rows\": %d, \"cols\": %d, \"mines\": %d, \"games\": %ld, \"wins\": %ld, "
+                 "\"win_rate\": %.6f, \"avg_opening\": %.3f, \"avg_3bv\": %.3f,\n     \"bbbv_histogram\": [",
+            first ? "" : ",", mode->name, mode->rows, mode->cols, mode->numMines, total->games, total->wins,
+            (double)total->wins / total->games, (double)total->openingCells / total->games, (double)total->bbbvSum / total->games);
+
+    // [3BV, games, wins] for every 3BV value that occurred
+    int firstEntry = 1;
+    for (j = 0; j <= simulation.maxBBBV; j++) {
+        if (total->bbbvGames[j]) {
+            fprintf(out, "%s[%d, %ld, %ld]", firstEntry ? "" : ", ", j, total->bbbvGames[j], total->bbbvWins[j]);
+            firstEntry = 0;
+        }
+    }
+    fprintf(out, "]}");
+
+    fprintf(stderr, "%-8s %ld games  win rate %.2f%%  avg opening %.1f cells  avg 3BV %.1f\n", mode->name, total->games,
+            100.0 * total->wins / total->games, (double)total->openingCells / total->games, (double)total->bbbvSum / total->games);
+
+    for (i = 0; i < threads; i++) {
+        freeMineField(&simulation.workers[i].field);
+        free(simulation.workers[i].bbbvGames);
+        free(simulation.workers[i].bbbvWins);
+    }
+    free(simulation.workers);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    long games = 1000000;
+    int threads = getCoreCount();
+    uint64_t seed = 1;
+    const char *modeName = "all";
+    const char *outputFile = NULL;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            modeName = argv[++i];
+        } else {
+            outputFile = argv[i];
+        }
+    }
+    if (games <= 0 || threads <= 0) {
+        fprintf(stderr, "Usage: self_play [--games N] [--mode easy|medium|hard|all] [--threads N] [--seed S] [output.json]\n");
+        return 1;
+    }
+
+    FILE *out = outputFile ? fopen(outputFile, "w") : stdout;
+    if (!out) {
+        perror("Error opening output file");
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"games_per_mode\": %ld, \"threads\": %d, \"seed\": %llu,\n  \"modes\": [", games, threads, (unsigned long long)seed);
+    int first = 1;
+    for (i = 0; i < NUM_MODE_PRESETS; i++) {
+        if (strcmp(modeName, "all") == 0 || strcmp(modeName, modePresets[i].name) == 0) {
+            if (!simulateMode(&modePresets[i], games, threads, seed, out, first)) {
+                return 1;
+            }
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}